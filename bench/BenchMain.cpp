@@ -0,0 +1,257 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "SyntheticUnit.hpp"
+#include "ModuleAnalysis.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <sys/resource.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+#include <clang/Basic/FileManager.h>
+#include <clang/Basic/FileSystemOptions.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/FrontendAction.h>
+#include <clang/Tooling/Tooling.h>
+
+
+namespace {
+
+static char const * const tool_name = "constantine-bench";
+
+// Count the diagnostics, instead of printing them. (Printing thousands
+// of warnings would dominate the measured time.)
+class CountingConsumer : public clang::DiagnosticConsumer {
+public:
+    CountingConsumer()
+        : clang::DiagnosticConsumer()
+    { }
+};
+
+// Parse the source, and run the analysis when it was asked.
+class BenchAction : public clang::ASTFrontendAction {
+public:
+    explicit BenchAction(bool const Analyse)
+        : clang::ASTFrontendAction()
+        , WithAnalysis(Analyse)
+    { }
+
+private:
+    std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance & C, llvm::StringRef) override {
+        return WithAnalysis
+            ? std::unique_ptr<clang::ASTConsumer>(new ModuleAnalysis(C, Options()))
+            : std::unique_ptr<clang::ASTConsumer>(new clang::ASTConsumer());
+    }
+
+private:
+    bool const WithAnalysis;
+};
+
+// Measures the wall clock time of the compilation in milliseconds. Returns
+// false when the unit did not compile, its measures are not valid then.
+bool Compile(std::string const & Source, bool const WithAnalysis, double & Millis, unsigned & Findings) {
+    static char const * const FileName = "synthetic.cpp";
+    std::vector<std::string> const Args = { tool_name, "-fsyntax-only", "-std=c++11", FileName };
+
+    llvm::IntrusiveRefCntPtr<clang::FileManager> Files(
+        new clang::FileManager(clang::FileSystemOptions()));
+    CountingConsumer Consumer;
+    clang::tooling::ToolInvocation Invocation(Args, new BenchAction(WithAnalysis), Files.get());
+    Invocation.setDiagnosticConsumer(&Consumer);
+    Invocation.mapVirtualFile(FileName, Source);
+
+    auto const Start = std::chrono::steady_clock::now();
+    bool const Compiled = Invocation.run();
+    auto const Stop = std::chrono::steady_clock::now();
+
+    Findings = Consumer.getNumWarnings();
+    Millis = std::chrono::duration<double, std::milli>(Stop - Start).count();
+    return Compiled && (0 == Consumer.getNumErrors());
+}
+
+// The result of one measured configuration.
+struct Measure {
+    double ParseTime;
+    double AnalysisTime;
+    unsigned Findings;
+};
+
+// Best of the given repeats, both without and with the analysis. Returns
+// false when any of the compilations failed.
+bool Run(std::string const & Source, unsigned const Repeat, Measure & Result) {
+    Result = Measure { 0.0, 0.0, 0 };
+    for (unsigned It = 0; It < Repeat; ++It) {
+        unsigned Findings = 0;
+        double Parse = 0.0;
+        double Analysis = 0.0;
+        if (! Compile(Source, false, Parse, Findings))
+            return false;
+        if (! Compile(Source, true, Analysis, Result.Findings))
+            return false;
+        Result.ParseTime = (0 == It) ? Parse : std::min(Result.ParseTime, Parse);
+        Result.AnalysisTime = (0 == It) ? Analysis : std::min(Result.AnalysisTime, Analysis);
+    }
+    return true;
+}
+
+// Every configuration is measured in a child process, so the peak memory
+// (maximum resident set size) is reported for that configuration alone.
+// The compilation itself runs in-process in the child. (A configuration
+// which does not compile is reported as failed, not measured.)
+bool RunIsolated(std::string const & Source, unsigned const Repeat, Measure & Result, long & PeakKB) {
+    int Pipe[2];
+    if (0 != pipe(Pipe))
+        return false;
+
+    pid_t const Child = fork();
+    if (Child < 0)
+        return false;
+    if (0 == Child) {
+        close(Pipe[0]);
+        Measure Current;
+        if (! Run(Source, Repeat, Current))
+            _exit(1);
+        bool const Written =
+            (static_cast<ssize_t>(sizeof(Current)) == write(Pipe[1], &Current, sizeof(Current)));
+        _exit(Written ? 0 : 1);
+    }
+    close(Pipe[1]);
+    bool const Read =
+        (static_cast<ssize_t>(sizeof(Result)) == read(Pipe[0], &Result, sizeof(Result)));
+    close(Pipe[0]);
+
+    int Status = 0;
+    struct rusage Usage;
+    if (Child != wait4(Child, &Status, 0, &Usage))
+        return false;
+
+    PeakKB = Usage.ru_maxrss;
+    return Read && WIFEXITED(Status) && (0 == WEXITSTATUS(Status));
+}
+
+struct Configuration {
+    std::string Name;
+    UnitShape Shape;
+};
+
+// Scaling series: one parameter grows, the others are on the default.
+std::vector<Configuration> GetConfigurations() {
+    std::vector<Configuration> Result;
+    auto const Series = [&Result](char const * const Name, unsigned UnitShape::* const Field,
+                                  std::vector<unsigned> const & Values) {
+        for (auto && Value : Values) {
+            Configuration Current;
+            Current.Name = std::string(Name) + "=" + std::to_string(Value);
+            Current.Shape.*Field = Value;
+            Result.push_back(Current);
+        }
+    };
+    Series("functions", &UnitShape::Functions, { 50, 100, 200, 400, 800 });
+    Series("locals", &UnitShape::Locals, { 10, 20, 40, 80, 160 });
+    Series("depth", &UnitShape::ExpressionDepth, { 4, 16, 64, 128, 256 });
+    Series("class-size", &UnitShape::ClassSize, { 10, 20, 40, 80, 160 });
+    Series("inheritance", &UnitShape::InheritanceDepth, { 2, 4, 8, 16, 32 });
+    Series("diamonds", &UnitShape::Diamonds, { 0, 1, 2 });
+    Series("reference-chain", &UnitShape::ReferenceChain, { 2, 8, 32, 128, 512 });
+    return Result;
+}
+
+void PrintUsage() {
+    llvm::errs()
+        << "usage: " << tool_name << " [-repeat <n>] [-filter <text>] [-dump]\n"
+        << "\n"
+        << "Generates synthetic translation units and measures the analysis on\n"
+        << "them. Time is the best of the repeats in milliseconds, memory is the\n"
+        << "peak resident set size of the configuration.\n"
+        << "\n"
+        << "  -repeat <n>     number of measures per configuration (default 3)\n"
+        << "  -filter <text>  run only configurations containing the text\n"
+        << "  -dump           print the generated sources instead of measuring\n";
+}
+
+} // namespace anonymous
+
+
+int main(int argc, char const * argv[]) {
+    unsigned Repeat = 3;
+    std::string Filter;
+    bool Dump = false;
+    for (int It = 1; It < argc; ++It) {
+        llvm::StringRef const Arg(argv[It]);
+        if ((Arg == "-repeat") && (It + 1 < argc)) {
+            if (llvm::StringRef(argv[++It]).getAsInteger(10, Repeat) || (0 == Repeat)) {
+                PrintUsage();
+                return 1;
+            }
+        } else if ((Arg == "-filter") && (It + 1 < argc)) {
+            Filter = argv[++It];
+        } else if (Arg == "-dump") {
+            Dump = true;
+        } else {
+            PrintUsage();
+            return (Arg == "-help" || Arg == "--help") ? 0 : 1;
+        }
+    }
+
+    if (! Dump) {
+        llvm::outs() << llvm::format("%-24s %10s %12s %12s %12s %10s\n",
+            "configuration", "findings", "parse ms", "analysed ms", "overhead ms", "peak KB");
+        llvm::outs().flush();
+    }
+
+    bool Failed = false;
+    for (auto && Config : GetConfigurations()) {
+        if (llvm::StringRef(Config.Name).find(Filter) == llvm::StringRef::npos)
+            continue;
+
+        std::string const Source = GenerateUnit(Config.Shape);
+        if (Dump) {
+            llvm::outs() << "// " << Config.Name << "\n" << Source << "\n";
+            continue;
+        }
+        Measure Result;
+        long PeakKB = 0;
+        if (! RunIsolated(Source, Repeat, Result, PeakKB)) {
+            llvm::errs() << tool_name << ": configuration '" << Config.Name << "' failed\n";
+            Failed = true;
+            continue;
+        }
+        llvm::outs() << llvm::format("%-24s %10u %12.2f %12.2f %12.2f %10ld\n",
+            Config.Name.c_str(),
+            Result.Findings,
+            Result.ParseTime,
+            Result.AnalysisTime,
+            Result.AnalysisTime - Result.ParseTime,
+            PeakKB);
+        llvm::outs().flush();
+    }
+    return Failed ? 1 : 0;
+}
@@ -0,0 +1,250 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "DeclarationCollector.hpp"
+#include "ScopeAnalysis.hpp"
+
+#include <chrono>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Tooling/Tooling.h>
+
+
+namespace {
+
+static char const * const tool_name = "constantine-microbench";
+
+// Find the first named declaration of the given kind.
+template <typename T>
+class NamedDeclFinder
+    : public clang::RecursiveASTVisitor<NamedDeclFinder<T>> {
+public:
+    static T const * Find(clang::ASTContext & Ctx, llvm::StringRef const Name) {
+        NamedDeclFinder Finder(Name);
+        Finder.TraverseDecl(Ctx.getTranslationUnitDecl());
+        return Finder.Found;
+    }
+
+    bool VisitNamedDecl(clang::NamedDecl * const D) {
+        if (auto const Candidate = clang::dyn_cast<T>(D)) {
+            if (Candidate->getIdentifier() && (Candidate->getName() == Name)) {
+                Found = Candidate;
+                return false;
+            }
+        }
+        return true;
+    }
+
+private:
+    explicit NamedDeclFinder(llvm::StringRef const N)
+        : clang::RecursiveASTVisitor<NamedDeclFinder<T>>()
+        , Name(N)
+        , Found(nullptr)
+    { }
+
+private:
+    llvm::StringRef const Name;
+    T const * Found;
+};
+
+// Class chain with a diamond on every level.
+std::string DeepHierarchy(unsigned const Depth) {
+    std::string Result = "struct B0 { int f0; int m0() { return f0; } };\n";
+    for (unsigned It = 1; It <= Depth; ++It) {
+        std::string const Previous = "B" + std::to_string(It - 1);
+        std::string const Current = "B" + std::to_string(It);
+        std::string const Index = std::to_string(It);
+        Result += "struct L" + Index + " : virtual " + Previous + " { int lf" + Index + "; };\n";
+        Result += "struct R" + Index + " : virtual " + Previous + " { int rf" + Index + "; };\n";
+        Result += "struct " + Current + " : L" + Index + ", R" + Index
+               +  " { int f" + Index + "; int m" + Index + "() { return f" + Index + "; } };\n";
+    }
+    Result += "struct Target : B" + std::to_string(Depth) + " { };\n";
+    return Result;
+}
+
+// References to references, the last one named 'target'.
+std::string AliasChain(unsigned const Length) {
+    std::string Result = "void function() {\n    int value = 0;\n    int & r0 = value;\n";
+    for (unsigned It = 1; It < Length; ++It) {
+        Result += "    int & r" + std::to_string(It) + " = r" + std::to_string(It - 1) + ";\n";
+    }
+    Result += "    int & target = r" + std::to_string(Length - 1) + ";\n    target = 1;\n}\n";
+    return Result;
+}
+
+// Conditional operators nested into the false branch.
+std::string NestedConditionals(unsigned const Depth) {
+    std::string Result = "void function(bool c) {\n";
+    for (unsigned It = 0; It <= Depth; ++It) {
+        Result += "    int a" + std::to_string(It) + " = 0;\n";
+    }
+    std::string Init = "a" + std::to_string(Depth);
+    for (unsigned It = Depth; It > 0; --It) {
+        Init = "(c ? a" + std::to_string(It - 1) + " : " + Init + ")";
+    }
+    Result += "    int & target = " + Init + ";\n}\n";
+    return Result;
+}
+
+// Variable hidden under parentheses and unary operators.
+std::string WrappedExpression(unsigned const Depth) {
+    std::string Init = "a";
+    for (unsigned It = 0; It < Depth; ++It) {
+        Init = (0 == It % 2) ? ("(" + Init + ")") : ("+" + Init);
+    }
+    return "void function() {\n    int a = 0;\n    int target = " + Init + ";\n}\n";
+}
+
+// Function body with many locals, assignments and reads.
+std::string LargeBody(unsigned const Locals) {
+    std::string Result = "int function(int p) {\n";
+    for (unsigned It = 0; It < Locals; ++It) {
+        std::string const Name = "l" + std::to_string(It);
+        Result += "    int " + Name + " = p + " + std::to_string(It) + ";\n";
+        if (0 == It % 2) {
+            Result += "    " + Name + " += p;\n";
+        }
+    }
+    Result += "    return 0";
+    for (unsigned It = 0; It < Locals; ++It) {
+        Result += " + l" + std::to_string(It);
+    }
+    Result += ";\n}\n";
+    return Result;
+}
+
+std::unique_ptr<clang::ASTUnit> Build(std::string const & Code) {
+    return clang::tooling::buildASTFromCodeWithArgs(Code, { "-std=c++11" });
+}
+
+// Run the body repeatedly for a while, and print the average time.
+template <typename Body>
+void Measure(std::string const & Name, Body && Run) {
+    std::size_t Sink = 0;
+    unsigned Iterations = 0;
+    auto const Start = std::chrono::steady_clock::now();
+    auto Elapsed = std::chrono::steady_clock::duration::zero();
+    while ((Iterations < 10) || (Elapsed < std::chrono::milliseconds(200))) {
+        Sink += Run();
+        ++Iterations;
+        Elapsed = std::chrono::steady_clock::now() - Start;
+    }
+    double const PerCall =
+        std::chrono::duration<double, std::nano>(Elapsed).count() / Iterations;
+    llvm::outs() << llvm::format("%-40s %14.0f ns %10u iterations %10zu results\n",
+        Name.c_str(), PerCall, Iterations, Sink / Iterations);
+    llvm::outs().flush();
+}
+
+clang::Expr const * GetInit(clang::ASTContext & Ctx) {
+    auto const Target = NamedDeclFinder<clang::VarDecl>::Find(Ctx, "target");
+    return Target ? Target->getInit() : nullptr;
+}
+
+bool Selected(std::string const & Name, std::string const & Filter) {
+    return llvm::StringRef(Name).find(Filter) != llvm::StringRef::npos;
+}
+
+} // namespace anonymous
+
+
+int main(int argc, char const * argv[]) {
+    std::string Filter;
+    if ((3 == argc) && (llvm::StringRef(argv[1]) == "-filter")) {
+        Filter = argv[2];
+    } else if (1 != argc) {
+        llvm::errs() << "usage: " << tool_name << " [-filter <text>]\n";
+        return 1;
+    }
+
+    for (unsigned const Depth : { 4u, 16u, 64u }) {
+        std::string const Suffix = "/" + std::to_string(Depth);
+        std::unique_ptr<clang::ASTUnit> const Unit = Build(DeepHierarchy(Depth));
+        auto const Record = NamedDeclFinder<clang::CXXRecordDecl>::Find(Unit->getASTContext(), "Target");
+        if (! Record)
+            return 1;
+        if (Selected("AllBase" + Suffix, Filter))
+            Measure("AllBase" + Suffix, [Record]() { return AllBase(Record).size(); });
+        if (Selected("GetVariablesFromRecord" + Suffix, Filter))
+            Measure("GetVariablesFromRecord" + Suffix, [Record]() { return GetVariablesFromRecord(Record).size(); });
+        if (Selected("GetMethodsFromRecord" + Suffix, Filter))
+            Measure("GetMethodsFromRecord" + Suffix, [Record]() { return GetMethodsFromRecord(Record).size(); });
+    }
+    for (unsigned const Length : { 4u, 64u, 512u }) {
+        std::string const Name = "GetReferedVariables/" + std::to_string(Length);
+        if (! Selected(Name, Filter))
+            continue;
+        std::unique_ptr<clang::ASTUnit> const Unit = Build(AliasChain(Length));
+        auto const Target = NamedDeclFinder<clang::VarDecl>::Find(Unit->getASTContext(), "target");
+        if (! Target)
+            return 1;
+        Measure(Name, [Target]() { return GetReferedVariables(Target).size(); });
+    }
+    for (unsigned const Depth : { 4u, 64u, 256u }) {
+        std::string const Name = "CollectRefereeExpr/" + std::to_string(Depth);
+        if (! Selected(Name, Filter))
+            continue;
+        std::unique_ptr<clang::ASTUnit> const Unit = Build(NestedConditionals(Depth));
+        clang::Expr const * const Init = GetInit(Unit->getASTContext());
+        if (! Init)
+            return 1;
+        Measure(Name, [Init]() { return CollectRefereeExpr(Init).size(); });
+    }
+    for (unsigned const Depth : { 4u, 64u, 256u }) {
+        std::string const Name = "StripExpr/" + std::to_string(Depth);
+        if (! Selected(Name, Filter))
+            continue;
+        std::unique_ptr<clang::ASTUnit> const Unit = Build(WrappedExpression(Depth));
+        clang::Expr const * const Init = GetInit(Unit->getASTContext());
+        if (! Init)
+            return 1;
+        Measure(Name, [Init]() { return (StripExpr(Init) != Init) ? 1u : 0u; });
+    }
+    for (unsigned const Count : { 10u, 100u, 1000u }) {
+        std::string const Suffix = "/" + std::to_string(Count);
+        if (! Selected("ScopeAnalysis::AnalyseThis" + Suffix, Filter))
+            continue;
+        std::unique_ptr<clang::ASTUnit> const Unit = Build(LargeBody(Count));
+        auto const Function = NamedDeclFinder<clang::FunctionDecl>::Find(Unit->getASTContext(), "function");
+        if (! (Function && Function->getBody()))
+            return 1;
+        Variables const Locals = GetVariablesFromContext(Function);
+        clang::Stmt const & Body = *(Function->getBody());
+        // the analysis is lazy, the queries are doing the work.
+        Measure("ScopeAnalysis::AnalyseThis" + Suffix, [&Body, &Locals]() {
+            ScopeAnalysis const Analysis = ScopeAnalysis::AnalyseThis(Body);
+            std::size_t Result = 0;
+            for (auto && Variable : Locals) {
+                Result += Analysis.WasChanged(Variable) ? 1 : 0;
+                Result += Analysis.WasReferenced(Variable) ? 1 : 0;
+            }
+            return Result;
+        });
+    }
+    return 0;
+}
@@ -0,0 +1,160 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "SyntheticUnit.hpp"
+
+#include <llvm/Support/raw_ostream.h>
+
+
+namespace {
+
+// Nested expression of the given depth, using the given variables. The
+// operators and conditional operators are mixed.
+void GenerateExpression(llvm::raw_ostream & OS, unsigned const Depth, unsigned const Seed) {
+    if (0 == Depth) {
+        OS << "p" << (Seed % 2);
+        return;
+    }
+    switch (Seed % 3) {
+    case 0:
+        OS << "(p0 + ";
+        GenerateExpression(OS, Depth - 1, Seed + 1);
+        OS << ")";
+        break;
+    case 1:
+        OS << "(p1 * ";
+        GenerateExpression(OS, Depth - 1, Seed + 1);
+        OS << ")";
+        break;
+    default:
+        OS << "(p0 < p1 ? ";
+        GenerateExpression(OS, Depth - 1, Seed + 1);
+        OS << " : p1)";
+        break;
+    }
+}
+
+// Fields and methods of one class. Every third method changes a field,
+// the others are only reading (const or static candidates).
+void GenerateMembers(llvm::raw_ostream & OS, std::string const & Name, unsigned const Size) {
+    for (unsigned It = 0; It < Size; ++It) {
+        OS << "    int " << Name << "_f" << It << ";\n";
+    }
+    for (unsigned It = 0; It < Size; ++It) {
+        OS << "    int " << Name << "_m" << It << "(int p0, int p1) {\n";
+        switch (It % 3) {
+        case 0:
+            OS << "        " << Name << "_f" << It << " += p0;\n"
+               << "        return p1;\n";
+            break;
+        case 1:
+            OS << "        int const r = " << Name << "_f" << It << " + p0;\n"
+               << "        return r + p1;\n";
+            break;
+        default:
+            OS << "        return p0 + p1;\n";
+            break;
+        }
+        OS << "    }\n";
+    }
+}
+
+// Chain of classes, each one derived from the previous. The first few
+// levels of the chain are diamonds: two classes virtually derived from
+// the previous level, and the next level derived from both.
+std::string GenerateHierarchy(llvm::raw_ostream & OS, UnitShape const & Shape) {
+    std::string Previous;
+    for (unsigned Level = 0; Level <= Shape.InheritanceDepth; ++Level) {
+        std::string const Name = "C" + std::to_string(Level);
+        if (Previous.empty()) {
+            OS << "struct " << Name << " {\n";
+        } else if (Level <= Shape.Diamonds) {
+            std::string const Left = Name + "L";
+            std::string const Right = Name + "R";
+            OS << "struct " << Left << " : virtual " << Previous << " {\n";
+            GenerateMembers(OS, Left, Shape.ClassSize);
+            OS << "};\n\n";
+            OS << "struct " << Right << " : virtual " << Previous << " {\n";
+            GenerateMembers(OS, Right, Shape.ClassSize);
+            OS << "};\n\n";
+            OS << "struct " << Name << " : " << Left << ", " << Right << " {\n";
+        } else {
+            OS << "struct " << Name << " : " << Previous << " {\n";
+        }
+        GenerateMembers(OS, Name, Shape.ClassSize);
+        OS << "};\n\n";
+        Previous = Name;
+    }
+    return Previous;
+}
+
+// Free function with locals. Every other local is changed, the others
+// could be const. The reference chain ends with a change, which has to
+// be tracked back to the first variable.
+void GenerateFunction(llvm::raw_ostream & OS, UnitShape const & Shape,
+                      std::string const & Class, unsigned const Index) {
+    OS << "int function" << Index << "(int p0, int p1, " << Class << " & object) {\n";
+    for (unsigned It = 0; It < Shape.Locals; ++It) {
+        OS << "    int l" << It << " = ";
+        GenerateExpression(OS, Shape.ExpressionDepth, Index + It);
+        OS << ";\n";
+    }
+    for (unsigned It = 0; It < Shape.Locals; It += 2) {
+        OS << "    l" << It << " += p0;\n";
+    }
+    if (0 < Shape.ReferenceChain) {
+        OS << "    int chain = p1;\n"
+           << "    int & r0 = chain;\n";
+        for (unsigned It = 1; It < Shape.ReferenceChain; ++It) {
+            OS << "    int & r" << It << " = (p0 < p1) ? r" << (It - 1) << " : chain;\n";
+        }
+        OS << "    r" << (Shape.ReferenceChain - 1) << " += 1;\n";
+    }
+    OS << "    int result = object." << Class << "_m0(p0, p1);\n";
+    for (unsigned It = 0; It < Shape.Locals; ++It) {
+        OS << "    result += l" << It << ";\n";
+    }
+    OS << "    return result;\n"
+       << "}\n\n";
+}
+
+} // namespace anonymous
+
+
+UnitShape::UnitShape()
+    : Functions(50)
+    , Locals(10)
+    , ExpressionDepth(4)
+    , ClassSize(10)
+    , InheritanceDepth(2)
+    , Diamonds(0)
+    , ReferenceChain(2)
+{ }
+
+std::string GenerateUnit(UnitShape const & Shape) {
+    std::string Result;
+    llvm::raw_string_ostream OS(Result);
+    std::string const Class = GenerateHierarchy(OS, Shape);
+    for (unsigned It = 0; It < Shape.Functions; ++It) {
+        GenerateFunction(OS, Shape, Class, It);
+    }
+    OS.flush();
+    return Result;
+}
@@ -0,0 +1,41 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+
+
+// The parameters of a generated translation unit.
+struct UnitShape {
+    UnitShape();
+
+    unsigned Functions;         // number of free functions
+    unsigned Locals;            // number of local variables per function
+    unsigned ExpressionDepth;   // nesting depth of the initializer expressions
+    unsigned ClassSize;         // number of fields and methods per class
+    unsigned InheritanceDepth;  // length of the base class chain
+    unsigned Diamonds;          // number of diamonds in the base class chain
+    unsigned ReferenceChain;    // length of the reference chains in functions
+};
+
+// Generate C++ source code in the given shape. The same shape always
+// generates the same source.
+std::string GenerateUnit(UnitShape const &);
@@ -3,6 +3,9 @@
 #   CLANG_INCLUDE_DIRS
 #   CLANG_DEFINITIONS
 #   CLANG_EXECUTABLE
+#   CLANG_LIBRARY_DIRS
+#   CLANG_LIBRARIES
+#   LLVM_PROFDATA (optional)
 
 function(set_clang_definitions config_cmd)
   execute_process(
@@ -58,9 +61,43 @@ function(set_clang_include_dirs config_cmd)
   set(CLANG_INCLUDE_DIRS ${include_dirs} PARENT_SCOPE)
 endfunction()
 
+function(set_clang_libraries config_cmd)
+  execute_process(
+    COMMAND ${config_cmd} --libdir
+    OUTPUT_VARIABLE llvm_lib_dir
+    OUTPUT_STRIP_TRAILING_WHITESPACE)
+  execute_process(
+    COMMAND ${config_cmd} --libs
+    OUTPUT_VARIABLE llvm_libs
+    OUTPUT_STRIP_TRAILING_WHITESPACE)
+  execute_process(
+    COMMAND ${config_cmd} --system-libs
+    OUTPUT_VARIABLE llvm_system_libs
+    OUTPUT_STRIP_TRAILING_WHITESPACE)
+  separate_arguments(llvm_libs UNIX_COMMAND "${llvm_libs}")
+  separate_arguments(llvm_system_libs UNIX_COMMAND "${llvm_system_libs}")
+  # the order does matter for the static libraries.
+  list(APPEND libs
+    clangFrontend
+    clangSerialization
+    clangDriver
+    clangParse
+    clangSema
+    clangAnalysis
+    clangEdit
+    clangAST
+    clangLex
+    clangBasic)
+  list(APPEND libs ${llvm_libs})
+  list(APPEND libs ${llvm_system_libs})
+
+  set(CLANG_LIBRARY_DIRS ${llvm_lib_dir} PARENT_SCOPE)
+  set(CLANG_LIBRARIES ${libs} PARENT_SCOPE)
+endfunction()
+
 
 find_program(LLVM_CONFIG
-  NAMES llvm-config-3.8 llvm-config-3.7 llvm-config
+  NAMES llvm-config-3.8 llvm-config
   PATHS ENV LLVM_PATH)
 if(LLVM_CONFIG)
   message(STATUS "llvm-config found : ${LLVM_CONFIG}")
@@ -68,8 +105,17 @@ else()
   message(FATAL_ERROR "Can't found program: llvm-config")
 endif()
 
+# the sources are using 3.8 interfaces (eg. llvm::ThreadPool).
+execute_process(
+  COMMAND ${LLVM_CONFIG} --version
+  OUTPUT_VARIABLE LLVM_VERSION
+  OUTPUT_STRIP_TRAILING_WHITESPACE)
+if(LLVM_VERSION VERSION_LESS "3.8")
+  message(FATAL_ERROR "LLVM ${LLVM_VERSION} is too old, 3.8 is required")
+endif()
+
 find_program(CLANG_EXECUTABLE
-  NAMES clang-3.8 clang-3.7 clang
+  NAMES clang-3.8 clang
   PATHS ENV LLVM_PATH)
 if(CLANG_EXECUTABLE)
   message(STATUS "clang found : ${CLANG_EXECUTABLE}")
@@ -77,10 +123,20 @@ else()
   message(FATAL_ERROR "Can't found program: clang")
 endif()
 
+# only the tests of the profile input are using it.
+find_program(LLVM_PROFDATA
+  NAMES llvm-profdata-3.8 llvm-profdata
+  PATHS ENV LLVM_PATH)
+if(LLVM_PROFDATA)
+  message(STATUS "llvm-profdata found : ${LLVM_PROFDATA}")
+endif()
+
 set_clang_definitions(${LLVM_CONFIG})
 set_clang_include_dirs(${LLVM_CONFIG})
+set_clang_libraries(${LLVM_CONFIG})
 
 message(STATUS "llvm-config filtered cpp flags : ${CLANG_DEFINITIONS}")
 message(STATUS "llvm-config filtered include dirs : ${CLANG_INCLUDE_DIRS}")
+message(STATUS "llvm-config library dirs : ${CLANG_LIBRARY_DIRS}")
 
 set(CLANG_FOUND 1)
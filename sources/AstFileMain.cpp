@@ -0,0 +1,166 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ModuleAnalysis.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <llvm/ADT/IntrusiveRefCntPtr.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/ThreadPool.h>
+#include <llvm/Support/raw_ostream.h>
+#include <clang/Basic/DiagnosticOptions.h>
+#include <clang/Basic/FileSystemOptions.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Frontend/CompilerInstance.h>
+#include <clang/Frontend/PCHContainerOperations.h>
+#include <clang/Frontend/TextDiagnosticPrinter.h>
+
+
+namespace {
+
+static char const * const tool_name = "constantine-ast";
+
+// The result of one AST file analysis. The diagnostics are kept in
+// memory, to print them in the order of the input files.
+struct Outcome {
+    Outcome()
+        : Output()
+        , Failed(false)
+    { }
+
+    std::string Output;
+    bool Failed;
+};
+
+// Load the serialized AST and run the same analysis as the plugin does.
+// Every file has its own diagnostics engine and AST context, therefore
+// these can run on separate threads.
+void AnalyseFile(std::string const & File,
+                 Options const & Config,
+                 std::shared_ptr<clang::PCHContainerOperations> const & PCHOps,
+                 Outcome & Result) {
+    llvm::raw_string_ostream Stream(Result.Output);
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticOptions> DiagOpts(new clang::DiagnosticOptions());
+    clang::TextDiagnosticPrinter * const Printer =
+        new clang::TextDiagnosticPrinter(Stream, &*DiagOpts);
+    llvm::IntrusiveRefCntPtr<clang::DiagnosticsEngine> Diags =
+        clang::CompilerInstance::createDiagnostics(&*DiagOpts, Printer, true);
+
+    std::unique_ptr<clang::ASTUnit> const Unit =
+        clang::ASTUnit::LoadFromASTFile(File, PCHOps->getRawReader(), Diags,
+                                        clang::FileSystemOptions());
+    if (! Unit) {
+        Stream << tool_name << ": could not load AST file '" << File << "'\n";
+        Result.Failed = true;
+        return;
+    }
+    // Do nothing, just enjoy the non C++ code.
+    if (! Unit->getLangOpts().CPlusPlus)
+        return;
+
+    Printer->BeginSourceFile(Unit->getLangOpts(), &Unit->getPreprocessor());
+    {
+        ModuleAnalysis Analysis(*Diags, Config);
+        Analysis.HandleTranslationUnit(Unit->getASTContext());
+    }
+    Printer->EndSourceFile();
+    Result.Failed = Diags->hasErrorOccurred();
+}
+
+bool ParseJobs(llvm::StringRef const Value, unsigned & Out) {
+    return (! Value.getAsInteger(10, Out)) && (0 < Out);
+}
+
+void PrintUsage() {
+    llvm::errs()
+        << "usage: " << tool_name << " [-j <jobs>] [plugin arguments] <file.ast>...\n"
+        << "\n"
+        << "Runs the pseudo const analysis on serialized AST files (made by\n"
+        << "'clang -emit-ast' or as precompiled header). The plugin arguments\n"
+        << "are the same as for the plugin, in the '-name=value' form.\n";
+}
+
+} // namespace anonymous
+
+
+int main(int argc, char const * argv[]) {
+    std::vector<std::string> Arguments;
+    std::vector<std::string> Files;
+    unsigned Jobs = std::max(1u, std::thread::hardware_concurrency());
+    for (int It = 1; It < argc; ++It) {
+        llvm::StringRef const Arg(argv[It]);
+        if (Arg == "-j") {
+            if ((It + 1 == argc) || (! ParseJobs(argv[++It], Jobs))) {
+                PrintUsage();
+                return 1;
+            }
+        } else if (Arg.startswith("-j")) {
+            if (! ParseJobs(Arg.drop_front(2), Jobs)) {
+                PrintUsage();
+                return 1;
+            }
+        } else if (Arg == "-help" || Arg == "--help") {
+            PrintUsage();
+            return 0;
+        } else if (Arg.startswith("-")) {
+            Arguments.push_back(Arg);
+        } else {
+            Files.push_back(Arg);
+        }
+    }
+    if (Files.empty()) {
+        PrintUsage();
+        return 1;
+    }
+
+    Options Config;
+    {
+        std::string Error;
+        if (! ParseOptions(Arguments, Config, Error)) {
+            llvm::errs() << tool_name << ": " << Error << "\n";
+            return 1;
+        }
+    }
+
+    std::shared_ptr<clang::PCHContainerOperations> const PCHOps =
+        std::make_shared<clang::PCHContainerOperations>();
+    std::vector<Outcome> Outcomes(Files.size());
+    {
+        llvm::ThreadPool Pool(std::min<unsigned>(Jobs, Files.size()));
+        for (std::size_t It = 0; It < Files.size(); ++It) {
+            Pool.async([&, It]() {
+                AnalyseFile(Files[It], Config, PCHOps, Outcomes[It]);
+            });
+        }
+        Pool.wait();
+    }
+
+    bool Failed = false;
+    for (auto && Result : Outcomes) {
+        llvm::errs() << Result.Output;
+        Failed |= Result.Failed;
+    }
+    return Failed ? 1 : 0;
+}
@@ -0,0 +1,101 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Baseline.hpp"
+#include "Statistics.hpp"
+
+#include <cstring>
+#include <system_error>
+#include <utility>
+
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/ErrorOr.h>
+
+
+namespace {
+
+char const Magic[] = "CNSTBL01";
+std::size_t const MagicSize = sizeof(Magic) - 1;
+std::size_t const EntrySize = sizeof(std::uint64_t);
+
+std::uint64_t ReadEntry(char const * const Entries, std::size_t const Index) {
+    return llvm::support::endian::read<std::uint64_t, llvm::support::little, llvm::support::unaligned>(
+        Entries + Index * EntrySize);
+}
+
+} // namespace anonymous
+
+
+std::unique_ptr<Baseline> Baseline::Load(std::string const & Path, std::string & Error) {
+    // the content is not null terminated, it is allowed to be mapped.
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> File =
+        llvm::MemoryBuffer::getFile(Path, -1, false);
+    if (! File) {
+        Error = "cannot open '" + Path + "': " + File.getError().message();
+        return std::unique_ptr<Baseline>();
+    }
+    std::unique_ptr<llvm::MemoryBuffer> & Buffer = File.get();
+    if ((Buffer->getBufferSize() < MagicSize)
+        || (0 != std::memcmp(Buffer->getBufferStart(), Magic, MagicSize))
+        || (0 != (Buffer->getBufferSize() - MagicSize) % EntrySize)) {
+        Error = "'" + Path + "' is not a baseline file";
+        return std::unique_ptr<Baseline>();
+    }
+    return std::unique_ptr<Baseline>(new Baseline(std::move(Buffer)));
+}
+
+Baseline::Baseline(std::unique_ptr<llvm::MemoryBuffer> Input)
+    : Buffer(std::move(Input))
+    , Entries(Buffer->getBufferStart() + MagicSize)
+    , Size((Buffer->getBufferSize() - MagicSize) / EntrySize)
+{ }
+
+bool Baseline::Contains(std::uint64_t const Fingerprint) const {
+    std::size_t Low = 0;
+    std::size_t High = Size;
+    while (Low < High) {
+        std::size_t const Middle = Low + (High - Low) / 2;
+        std::uint64_t const Current = ReadEntry(Entries, Middle);
+        if (Current == Fingerprint)
+            return true;
+        if (Current < Fingerprint) {
+            Low = Middle + 1;
+        } else {
+            High = Middle;
+        }
+    }
+    return false;
+}
+
+
+BaselineFindingWriter::BaselineFindingWriter(Baseline const & B, FindingWriter & Target)
+    : FindingWriter()
+    , Accepted(B)
+    , Target(Target)
+{ }
+
+void BaselineFindingWriter::Write(FindingKind const Kind, clang::DeclaratorDecl const * const D,
+                                  Impact const & Estimate) {
+    if (Accepted.Contains(GenerateFingerprint(Kind, D))) {
+        Statistics::Count(FindingsSuppressed);
+        return;
+    }
+    Target.Write(Kind, D, Estimate);
+}
@@ -0,0 +1,70 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "Findings.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <llvm/Support/MemoryBuffer.h>
+
+
+// The set of accepted findings, which are not reported again.
+//
+// The file starts with an 8 byte magic ('CNSTBL01'), followed by the
+// fingerprints of the findings, as little endian 64 bit numbers in
+// ascending order. (See 'constantine-baseline' to build one.) The file is
+// memory mapped and searched in place, loading it does not depend on its
+// size.
+class Baseline {
+public:
+    static std::unique_ptr<Baseline> Load(std::string const & Path, std::string & Error);
+
+    bool Contains(std::uint64_t Fingerprint) const;
+
+    Baseline(Baseline const &) = delete;
+    Baseline & operator=(Baseline const &) = delete;
+
+private:
+    explicit Baseline(std::unique_ptr<llvm::MemoryBuffer>);
+
+private:
+    std::unique_ptr<llvm::MemoryBuffer> const Buffer;
+    char const * const Entries;
+    std::size_t const Size;
+};
+
+// Forwards only the findings which are not in the baseline.
+class BaselineFindingWriter : public FindingWriter {
+public:
+    BaselineFindingWriter(Baseline const &, FindingWriter &);
+
+    void Write(FindingKind, clang::DeclaratorDecl const *, Impact const &) override;
+
+    BaselineFindingWriter(BaselineFindingWriter const &) = delete;
+    BaselineFindingWriter & operator=(BaselineFindingWriter const &) = delete;
+
+private:
+    Baseline const & Accepted;
+    FindingWriter & Target;
+};
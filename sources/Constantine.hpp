@@ -0,0 +1,63 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "Options.hpp"
+#include "ScopeAnalysis.hpp"
+
+#include <vector>
+
+#include <clang/AST/AST.h>
+
+
+// Library interface of the analysis, for clang based tools which embed
+// it. (Link with the 'constantine_analysis' static library.) The results
+// are declarations of the analysed AST, no diagnostics are emitted.
+
+// The changes and the usages of the variables in a function body.
+struct FunctionFacts {
+    clang::FunctionDecl const * Function;
+    UsageRefsMap Changed;
+    UsageRefsMap Used;
+};
+
+// The verdicts are in source order, and only declarations of the main
+// file are given (as the plugin reports those). The facts are in the
+// order of the traversal, and collected only on request. (The by value
+// parameters are given only on the thorough level.)
+struct AnalysisResults {
+    std::vector<clang::DeclaratorDecl const *> ConstVariables;
+    std::vector<clang::CXXMethodDecl const *> ConstMethods;
+    std::vector<clang::CXXMethodDecl const *> StaticMethods;
+    std::vector<clang::DeclaratorDecl const *> ByValueParameters;
+    std::vector<FunctionFacts> Facts;
+};
+
+// Analyse every function definition of the translation unit. The level is
+// the same as the '-analysis-level' of the plugin.
+AnalysisResults AnalyseTranslationUnit(clang::ASTContext &, bool WithFacts = false,
+                                       AnalysisLevel = DefaultLevel);
+
+// Analyse only the given function definitions. (Declarations without body
+// are ignored.) A variable is given as const candidate when none of these
+// functions changes it.
+AnalysisResults AnalyseFunctions(std::vector<clang::FunctionDecl const *> const &, bool WithFacts = false,
+                                 AnalysisLevel = DefaultLevel);
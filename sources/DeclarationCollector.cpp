@@ -18,31 +18,50 @@
  */
 
 #include "DeclarationCollector.hpp"
+#include "Statistics.hpp"
 
 
 namespace {
 
-std::set<clang::CXXRecordDecl const *> AllBase(clang::CXXRecordDecl const * Record) {
-    std::set<clang::CXXRecordDecl const *> Result;
+clang::DeclaratorDecl const * GetDeclarationFromExpr(clang::Expr const * const E) {
+    clang::ValueDecl const * RefVal = nullptr;
+
+    if (auto const DRE = clang::dyn_cast<clang::DeclRefExpr const>(E)) {
+        RefVal = DRE->getDecl();
+    } else if (auto const ME = clang::dyn_cast<clang::MemberExpr const>(E)) {
+        RefVal = ME->getMemberDecl();
+    }
+
+    return (RefVal) ? clang::dyn_cast<clang::DeclaratorDecl const>(RefVal) : nullptr;
+}
+
+} // namespace anonymous
+
+
+Records AllBase(clang::CXXRecordDecl const * Record) {
+    Records Result;
 
     llvm::SmallVector<clang::CXXRecordDecl const *, 8> Queue;
     Queue.push_back(Record);
+    Result.insert(Record);
 
     while (! Queue.empty()) {
         auto const Current = Queue.pop_back_val();
+        Statistics::Count(RecordsWalked);
         for (const auto & BaseIt : Current->bases()) {
             if (auto const * Record = BaseIt.getType()->getAs<clang::RecordType>()) {
                 if (auto const * Base = clang::cast_or_null<clang::CXXRecordDecl>(Record->getDecl()->getDefinition())) {
-                    Queue.push_back(Base);
+                    // walk a shared (diamond) base only once.
+                    if (Result.insert(Base).second) {
+                        Queue.push_back(Base);
+                    }
                 }
             }
         }
-        Result.insert(Current);
     }
     return Result;
 }
 
-// Strip away parentheses and casts we don't care about.
 clang::Expr const * StripExpr(clang::Expr const * E) {
     while (E) {
         if (auto const * const Paren = clang::dyn_cast<clang::ParenExpr const>(E)) {
@@ -70,8 +89,8 @@ clang::Expr const * StripExpr(clang::Expr const * E) {
     return E;
 }
 
-std::set<clang::Expr const *> CollectRefereeExpr(clang::Expr const * const E) {
-    std::set<clang::Expr const *> Result;
+Expressions CollectRefereeExpr(clang::Expr const * const E) {
+    Expressions Result;
 
     std::set<clang::Expr const *> Works;
     Works.insert(E);
@@ -79,6 +98,7 @@ std::set<clang::Expr const *> CollectRefereeExpr(clang::Expr const * const E) {
     while (! Works.empty()) {
         auto const Current = *(Works.begin());
         Works.erase(Works.begin());
+        Statistics::Count(RefereeSteps);
 
         if (decltype(Current) const Stripped = StripExpr(Current)) {
             if (clang::dyn_cast<clang::DeclRefExpr const>(Stripped)) {
@@ -102,27 +122,15 @@ std::set<clang::Expr const *> CollectRefereeExpr(clang::Expr const * const E) {
     return Result;
 }
 
-clang::DeclaratorDecl const * GetDeclarationFromExpr(clang::Expr const * const E) {
-    clang::ValueDecl const * RefVal = nullptr;
-
-    if (auto const DRE = clang::dyn_cast<clang::DeclRefExpr const>(E)) {
-        RefVal = DRE->getDecl();
-    } else if (auto const ME = clang::dyn_cast<clang::MemberExpr const>(E)) {
-        RefVal = ME->getMemberDecl();
-    }
-
-    return (RefVal) ? clang::dyn_cast<clang::DeclaratorDecl const>(RefVal) : nullptr;
-}
-
-} // namespace anonymous
-
 
 Variables GetVariablesFromContext(clang::DeclContext const * const F, bool const WithArgs) {
+    Statistics::PhaseTimer const Timer(DeclarationCollectorPhase);
     Variables Result;
     for (auto const & It : F->decls()) {
         if (auto const D = clang::dyn_cast<clang::VarDecl const>(It)) {
             if (WithArgs || (!clang::dyn_cast<clang::ParmVarDecl const>(D))) {
                 Result.insert(D);
+                Statistics::Count(DeclarationsInserted);
             }
         }
     }
@@ -130,26 +138,31 @@ Variables GetVariablesFromContext(clang::DeclContext const * const F, bool const
 }
 
 Variables GetVariablesFromRecord(clang::CXXRecordDecl const * const Record) {
+    Statistics::PhaseTimer const Timer(DeclarationCollectorPhase);
     Variables Result;
     for (auto const & RecordIt : AllBase(Record)) {
         for (const auto & FieldIt : RecordIt->fields()) {
             Result.insert(FieldIt);
+            Statistics::Count(DeclarationsInserted);
         }
     }
     return Result;
 }
 
 Methods GetMethodsFromRecord(clang::CXXRecordDecl const * const Record) {
+    Statistics::PhaseTimer const Timer(DeclarationCollectorPhase);
     Methods Result;
     for (auto const & RecordIt : AllBase(Record)) {
         for (auto const & MethodIt : RecordIt->methods()) {
             Result.insert(MethodIt->getCanonicalDecl());
+            Statistics::Count(DeclarationsInserted);
         }
     }
     return Result;
 }
 
 Variables GetReferedVariables(clang::DeclaratorDecl const * const D) {
+    Statistics::PhaseTimer const Timer(AliasWalkPhase);
     Variables Result;
 
     Variables Works;
@@ -159,6 +172,7 @@ Variables GetReferedVariables(clang::DeclaratorDecl const * const D) {
         // get the current element
         auto const Current = *(Works.begin());
         Works.erase(Works.begin());
+        Statistics::Count(AliasSteps);
         // current element goes into results
         if (Current) {
             Result.insert(Current);
@@ -184,7 +198,13 @@ Variables GetReferedVariables(clang::DeclaratorDecl const * const D) {
 }
 
 Variables GetMemberVariablesAndReferences(clang::CXXRecordDecl const * const Rec, clang::DeclContext const * const F) {
-    Variables Members = GetVariablesFromRecord(Rec);
+    Statistics::PhaseTimer const Timer(DeclarationCollectorPhase);
+    return GetMemberVariablesAndReferences(GetVariablesFromRecord(Rec), F);
+}
+
+Variables GetMemberVariablesAndReferences(Variables const & Fields, clang::DeclContext const * const F) {
+    Statistics::PhaseTimer const Timer(DeclarationCollectorPhase);
+    Variables Members = Fields;
     Variables const & Locals = GetVariablesFromContext(F);
     for (auto const &Local : Locals) {
         Variables const &Refs = GetReferedVariables(Local);
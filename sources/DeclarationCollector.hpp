@@ -25,6 +25,18 @@
 
 typedef std::set<clang::DeclaratorDecl const *> Variables;
 typedef std::set<clang::CXXMethodDecl const *> Methods;
+typedef std::set<clang::CXXRecordDecl const *> Records;
+typedef std::set<clang::Expr const *> Expressions;
+
+// method to get the record and all of its (defined) base records
+Records AllBase(clang::CXXRecordDecl const * Record);
+
+// method to strip away parentheses and casts we don't care about
+clang::Expr const * StripExpr(clang::Expr const * E);
+
+// method to get the variable access expressions which the given
+// expression might refer to (it digs into conditional operators)
+Expressions CollectRefereeExpr(clang::Expr const * const E);
 
 // method to copy variables out from declaration context
 Variables GetVariablesFromContext(clang::DeclContext const * const F, bool const WithArgs = true);
@@ -41,3 +53,6 @@ Variables GetReferedVariables(clang::DeclaratorDecl const *);
 
 // method to get all member variables and all refered declarations
 Variables GetMemberVariablesAndReferences(clang::CXXRecordDecl const * const Rec, clang::DeclContext const * const F);
+
+// same as above, when the member variables are already collected
+Variables GetMemberVariablesAndReferences(Variables const & Members, clang::DeclContext const * const F);
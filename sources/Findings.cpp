@@ -0,0 +1,552 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Findings.hpp"
+#include "SourceOrder.hpp"
+
+#include <algorithm>
+#include <cctype>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringExtras.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/Endian.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/Path.h>
+#include <clang/Basic/FileManager.h>
+
+
+namespace {
+
+char const * const FindingNames[FindingKindCount] =
+    { "variable-const"
+    , "function-const"
+    , "function-static"
+    , "parameter-by-value"
+    };
+
+char const * const FindingMessages[FindingKindCount] =
+    { "variable '%0' could be declared as const"
+    , "function '%0' could be declared as const"
+    , "function '%0' could be declared as static"
+    , "parameter '%0' is copied, it could be passed by const reference"
+    };
+
+// The instantiation with its template arguments. (eg. 'f<std::string>')
+std::string GetInstanceName(clang::FunctionDecl const * const F) {
+    std::string Result;
+    llvm::raw_string_ostream OS(Result);
+    F->getNameForDiagnostic(OS, F->getASTContext().getPrintingPolicy(), true);
+    return OS.str();
+}
+
+// The location where the template was instantiated, the declaration when
+// that is not known.
+clang::SourceLocation GetInstanceLocation(clang::FunctionDecl const * const F) {
+    clang::SourceLocation const Location = F->getPointOfInstantiation();
+    return Location.isValid() ? Location : F->getLocation();
+}
+
+std::string FormatMessage(FindingKind const Kind, std::string const & Name) {
+    std::string Result = FindingMessages[Kind];
+    Result.replace(Result.find("%0"), 2, Name);
+    return Result;
+}
+
+
+// The position of the declaration among the same named declarations of its
+// function, or among the lambdas of its function. (The blocks of the
+// function are not declaration contexts, the locals of sibling blocks are
+// told apart only by this.)
+unsigned GetLocalOrdinal(clang::Decl const * const D) {
+    clang::DeclContext const * const Context = D->getDeclContext();
+    if ((! Context) || (! Context->isFunctionOrMethod()))
+        return 0;
+
+    auto const IsLambda = [](clang::Decl const * const It) {
+        auto const R = clang::dyn_cast<clang::CXXRecordDecl const>(It);
+        return R && R->isLambda();
+    };
+    auto const Named = clang::dyn_cast<clang::NamedDecl const>(D);
+    unsigned Result = 0;
+    for (auto const It : Context->decls()) {
+        if (It == D)
+            return Result;
+        if (IsLambda(D)) {
+            Result += IsLambda(It) ? 1 : 0;
+        } else if (auto const N = clang::dyn_cast<clang::NamedDecl const>(It)) {
+            Result += (Named && (N->getDeclName() == Named->getDeclName())) ? 1 : 0;
+        }
+    }
+    return 0;
+}
+
+void AppendUSR(llvm::raw_ostream & OS, clang::Decl const * const D) {
+    clang::DeclContext const * const Context = D->getDeclContext();
+    if (Context && (! Context->isTranslationUnit())) {
+        AppendUSR(OS, clang::Decl::castFromDeclContext(Context));
+    }
+
+    // the first of the same named locals has no ordinal, as before.
+    unsigned const Ordinal = GetLocalOrdinal(D);
+    if (auto const NS = clang::dyn_cast<clang::NamespaceDecl const>(D)) {
+        if (NS->isAnonymousNamespace()) {
+            OS << "@aN";
+        } else {
+            OS << "@N@" << NS->getNameAsString();
+        }
+    } else if (auto const R = clang::dyn_cast<clang::RecordDecl const>(D)) {
+        OS << (R->isUnion() ? "@U" : "@S");
+        auto const L = clang::dyn_cast<clang::CXXRecordDecl const>(R);
+        if (L && L->isLambda()) {
+            OS << "a@L" << Ordinal;
+        } else if (R->getIdentifier()) {
+            OS << '@' << R->getNameAsString();
+        } else {
+            OS << 'a';
+        }
+    } else if (auto const F = clang::dyn_cast<clang::FunctionDecl const>(D)) {
+        OS << "@F@" << F->getNameAsString() << '(';
+        for (unsigned It = 0, End = F->getNumParams(); It != End; ++It) {
+            OS << ((0 == It) ? "" : ",")
+               << F->getParamDecl(It)->getType().getCanonicalType().getAsString();
+        }
+        OS << ')';
+        if (auto const M = clang::dyn_cast<clang::CXXMethodDecl const>(F)) {
+            OS << (M->isConst() ? "const" : "");
+        }
+    } else if (auto const Field = clang::dyn_cast<clang::FieldDecl const>(D)) {
+        OS << "@FI@" << Field->getNameAsString();
+    } else if (auto const N = clang::dyn_cast<clang::NamedDecl const>(D)) {
+        OS << '@' << N->getNameAsString();
+        if (0 != Ordinal) {
+            OS << '@' << Ordinal;
+        }
+    }
+}
+
+
+void WriteString(llvm::raw_ostream & OS, llvm::StringRef const Value) {
+    OS << '"';
+    for (char const C : Value) {
+        switch (C) {
+        case '"':
+            OS << "\\\"";
+            break;
+        case '\\':
+            OS << "\\\\";
+            break;
+        case '\n':
+            OS << "\\n";
+            break;
+        case '\t':
+            OS << "\\t";
+            break;
+        default:
+            if (static_cast<unsigned char>(C) < 0x20) {
+                OS << llvm::format("\\u%04x", static_cast<unsigned>(C));
+            } else {
+                OS << C;
+            }
+        }
+    }
+    OS << '"';
+}
+
+// The file path as URI reference: absolute paths get the 'file://' scheme,
+// and every character but the unreserved ones and the separators is
+// percent-encoded. (Spaces, '#' and '%' would make the URI invalid.)
+std::string GetFileURI(llvm::StringRef const File) {
+    std::string Result = llvm::sys::path::is_absolute(File) ? "file://" : "";
+    for (char const C : File) {
+        if (std::isalnum(static_cast<unsigned char>(C)) || (llvm::StringRef::npos != llvm::StringRef("-._~/:").find(C))) {
+            Result += C;
+        } else {
+            unsigned char const Byte = static_cast<unsigned char>(C);
+            Result += '%';
+            Result += llvm::hexdigit(Byte >> 4);
+            Result += llvm::hexdigit(Byte & 0xF);
+        }
+    }
+    return Result;
+}
+
+// The file name when the output is a directory: the main file name and
+// the hash of its full path. (Same named files in different directories
+// won't overwrite each other.)
+std::string GetOutputPath(std::string const & Path, OutputFormat const Format,
+                          clang::SourceManager const & SM) {
+    if (! llvm::sys::fs::is_directory(Path))
+        return Path;
+
+    clang::FileEntry const * const Main = SM.getFileEntryForID(SM.getMainFileID());
+    llvm::StringRef const Name = Main ? Main->getName() : "unknown";
+
+    llvm::MD5 Hash;
+    Hash.update(Name);
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    llvm::SmallString<32> Hex;
+    llvm::MD5::stringifyResult(Result, Hex);
+
+    llvm::SmallString<256> Output(Path);
+    llvm::sys::path::append(Output, llvm::sys::path::filename(Name) + "-" + Hex.str()
+        + ((SarifOutput == Format) ? ".sarif" : ".jsonl"));
+    return Output.str();
+}
+
+// The value is copied (or moved) by the declaration: a parameter passed by
+// value, or a variable initialized by a copy or move constructor.
+bool IsCopied(clang::DeclaratorDecl const * const D) {
+    clang::QualType const Type = D->getType();
+    if (Type->isReferenceType() || Type->isDependentType())
+        return false;
+
+    if (clang::isa<clang::ParmVarDecl const>(D))
+        return HasNonTrivialCopy(Type);
+    if (auto const V = clang::dyn_cast<clang::VarDecl const>(D)) {
+        clang::Expr const * Init = V->getInit();
+        if (auto const Cleanups = clang::dyn_cast_or_null<clang::ExprWithCleanups const>(Init)) {
+            Init = Cleanups->getSubExpr();
+        }
+        if (auto const Construct = clang::dyn_cast_or_null<clang::CXXConstructExpr const>(Init)) {
+            return Construct->getConstructor()->isCopyOrMoveConstructor();
+        }
+    }
+    return false;
+}
+
+} // namespace anonymous
+
+
+char const * GetFindingName(FindingKind const Kind) {
+    return FindingNames[Kind];
+}
+
+std::string GenerateUSR(clang::Decl const * const D) {
+    std::string Result = "c:";
+    llvm::raw_string_ostream OS(Result);
+    AppendUSR(OS, D);
+    return OS.str();
+}
+
+std::uint64_t GenerateFingerprint(FindingKind const Kind, clang::DeclaratorDecl const * const D) {
+    llvm::MD5 Hash;
+    Hash.update(FindingNames[Kind]);
+    Hash.update(llvm::StringRef("", 1));
+    Hash.update(GenerateUSR(D));
+    Hash.update(llvm::StringRef("", 1));
+    if (auto const F = clang::dyn_cast_or_null<clang::FunctionDecl const>(D->getParentFunctionOrMethod())) {
+        Hash.update(GenerateUSR(F));
+    }
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    // the first 8 bytes of the digest.
+    return llvm::support::endian::read<std::uint64_t, llvm::support::little, llvm::support::unaligned>(Result);
+}
+
+
+bool HasNonTrivialCopy(clang::QualType const Type) {
+    clang::CXXRecordDecl const * const Record = Type->getAsCXXRecordDecl();
+    return Record && Record->hasDefinition()
+        && (Record->hasNonTrivialCopyConstructor() || Record->hasNonTrivialMoveConstructor());
+}
+
+std::uint64_t GetTypeBytes(clang::ASTContext const & Ctx, clang::QualType const Type) {
+    if (Type.isNull() || Type->isDependentType() || Type->isIncompleteType())
+        return 0;
+    return Ctx.getTypeSizeInChars(Type).getQuantity();
+}
+
+Impact EstimateImpact(clang::DeclaratorDecl const * const D, unsigned const LoopDepth) {
+    clang::ASTContext const & Ctx = D->getASTContext();
+    if (auto const M = clang::dyn_cast<clang::CXXMethodDecl const>(D)) {
+        // the layout of a class template pattern is not known.
+        clang::CXXRecordDecl const * const Record = M->getParent();
+        std::uint64_t const Bytes =
+            Record->isDependentContext() ? 0 : GetTypeBytes(Ctx, Ctx.getRecordType(Record));
+        return Impact { Bytes, false, LoopDepth, true, false, 0, {} };
+    }
+    return Impact { GetTypeBytes(Ctx, D->getType().getNonReferenceType()), IsCopied(D), LoopDepth, true,
+                    false, 0, {} };
+}
+
+std::uint64_t GetImpactScore(Impact const & Estimate) {
+    // the factors saturate, a huge score still ranks on the top.
+    std::uint64_t Result = std::max<std::uint64_t>(Estimate.Bytes, 1);
+    if (Estimate.Copies) {
+        Result = llvm::SaturatingMultiply<std::uint64_t>(Result, 16);
+    }
+    // deeper than this does not make a difference in practice.
+    for (unsigned It = 0; It < std::min(Estimate.LoopDepth, 6u); ++It) {
+        Result = llvm::SaturatingMultiply<std::uint64_t>(Result, 10);
+    }
+    if (Estimate.Profiled) {
+        Result = llvm::SaturatingMultiply<std::uint64_t>(Result, std::max<std::uint64_t>(Estimate.EntryCount, 1));
+    }
+    return Result;
+}
+
+
+FindingWriters::FindingWriters()
+    : FindingWriter()
+    , Writers()
+{ }
+
+void FindingWriters::Add(FindingWriter & Writer) {
+    Writers.push_back(&Writer);
+}
+
+void FindingWriters::Write(FindingKind const Kind, clang::DeclaratorDecl const * const D,
+                           Impact const & Estimate) {
+    for (auto && Writer : Writers) {
+        Writer->Write(Kind, D, Estimate);
+    }
+}
+
+
+SortedFindingWriter::SortedFindingWriter(FindingWriter & Target,
+                                         bool const ByImpact,
+                                         std::uint64_t const MinImpact,
+                                         std::uint64_t const MinEntryCount)
+    : FindingWriter()
+    , Target(Target)
+    , ByImpact(ByImpact)
+    , MinImpact(MinImpact)
+    , MinEntryCount(MinEntryCount)
+    , Findings()
+{ }
+
+void SortedFindingWriter::Write(FindingKind const Kind, clang::DeclaratorDecl const * const D,
+                                Impact const & Estimate) {
+    std::uint64_t const Score = GetImpactScore(Estimate);
+    if (Score < MinImpact)
+        return;
+    if ((0 != MinEntryCount) && ((! Estimate.Profiled) || (Estimate.EntryCount < MinEntryCount)))
+        return;
+    Findings.push_back(Finding { Kind, D, Estimate, Score });
+}
+
+void SortedFindingWriter::Flush() {
+    bool const RankByImpact = ByImpact;
+    std::stable_sort(Findings.begin(), Findings.end(),
+        [RankByImpact](Finding const & Lhs, Finding const & Rhs) {
+            if (RankByImpact && (Lhs.Score != Rhs.Score))
+                return Lhs.Score > Rhs.Score;
+            if (IsBeforeInSource(Lhs.Decl, Rhs.Decl))
+                return true;
+            if (IsBeforeInSource(Rhs.Decl, Lhs.Decl))
+                return false;
+            return Lhs.Kind < Rhs.Kind;
+        });
+    Findings.erase(std::unique(Findings.begin(), Findings.end(),
+        [](Finding const & Lhs, Finding const & Rhs) {
+            return (Lhs.Kind == Rhs.Kind) && (Lhs.Decl == Rhs.Decl);
+        }), Findings.end());
+    for (auto && Entry : Findings) {
+        Target.Write(Entry.Kind, Entry.Decl, Entry.Estimate);
+    }
+    Findings.clear();
+}
+
+
+TextFindingWriter::TextFindingWriter(clang::DiagnosticsEngine & DE)
+    : FindingWriter()
+    , Engine(DE)
+    , Ids()
+    , ProfileId(DE.getCustomDiagID(clang::DiagnosticsEngine::Note,
+                                   "the function was entered %0 times according to the profile"))
+    , InstanceId(DE.getCustomDiagID(clang::DiagnosticsEngine::Note,
+                                    "copied as '%0' by the instantiation '%1'"))
+{
+    for (unsigned It = 0; It < FindingKindCount; ++It) {
+        Ids[It] = DE.getCustomDiagID(clang::DiagnosticsEngine::Warning, FindingMessages[It]);
+    }
+}
+
+void TextFindingWriter::Write(FindingKind const Kind, clang::DeclaratorDecl const * const D,
+                              Impact const & Estimate) {
+    {
+        clang::DiagnosticBuilder const DB = Engine.Report(D->getLocStart(), Ids[Kind]);
+        DB << D->getNameAsString();
+        DB.setForceEmit();
+    }
+    if (Estimate.Profiled) {
+        clang::DiagnosticBuilder const DB = Engine.Report(D->getLocStart(), ProfileId);
+        DB << std::to_string(Estimate.EntryCount);
+        DB.setForceEmit();
+    }
+    for (auto && Instance : Estimate.Instances) {
+        clang::DiagnosticBuilder const DB = Engine.Report(GetInstanceLocation(Instance.Function), InstanceId);
+        DB << Instance.Type.getAsString() << GetInstanceName(Instance.Function);
+        DB.setForceEmit();
+    }
+}
+
+
+std::string StructuredFindingWriter::GetPath(std::string const & Path, OutputFormat const Format,
+                                             clang::SourceManager const & SM) {
+    return GetOutputPath(Path, Format, SM);
+}
+
+std::unique_ptr<StructuredFindingWriter>
+StructuredFindingWriter::Create(std::string const & Path,
+                                OutputFormat const Format,
+                                clang::SourceManager const & SM,
+                                std::string & Error) {
+    std::string const Output = GetOutputPath(Path, Format, SM);
+
+    int FD = -1;
+    llvm::SmallString<256> Temporary;
+    if (std::error_code const EC = llvm::sys::fs::createUniqueFile(Output + "-%%%%%%%%", FD, Temporary)) {
+        Error = "cannot create '" + Output + "': " + EC.message();
+        return std::unique_ptr<StructuredFindingWriter>();
+    }
+    return std::unique_ptr<StructuredFindingWriter>(
+        new StructuredFindingWriter(FD, Temporary.str(), Output, Format, SM));
+}
+
+StructuredFindingWriter::StructuredFindingWriter(int const FD,
+                                                 std::string const & Temporary,
+                                                 std::string const & Output,
+                                                 OutputFormat const F,
+                                                 clang::SourceManager const & SM)
+    : FindingWriter()
+    , Format(F)
+    , Sources(SM)
+    , TemporaryPath(Temporary)
+    , Path(Output)
+    , Out(FD, true)
+    , Count(0)
+    , Closed(false)
+    , Committed(false)
+{
+    if (SarifOutput == Format) {
+        Out << "{\"$schema\":\"https://json.schemastore.org/sarif-2.1.0.json\","
+            << "\"version\":\"2.1.0\",\"runs\":[{\"tool\":{\"driver\":{"
+            << "\"name\":\"constantine\",\"version\":\"" << CONSTANTINE_VERSION << "\","
+            << "\"informationUri\":\"https://github.com/rizsotto/Constantine\",\"rules\":[";
+        for (unsigned It = 0; It < FindingKindCount; ++It) {
+            Out << ((0 == It) ? "" : ",") << "{\"id\":\"" << FindingNames[It] << "\"}";
+        }
+        Out << "]}},\"results\":[\n";
+    }
+}
+
+StructuredFindingWriter::~StructuredFindingWriter() {
+    if (! Closed) {
+        Out.close();
+        Out.clear_error();
+    }
+    if (! Committed) {
+        llvm::sys::fs::remove(TemporaryPath);
+    }
+}
+
+void StructuredFindingWriter::Write(FindingKind const Kind, clang::DeclaratorDecl const * const D,
+                                    Impact const & Estimate) {
+    clang::SourceLocation const Location = Sources.getExpansionLoc(D->getLocStart());
+    llvm::StringRef const File = Sources.getFilename(Location);
+    unsigned const Line = Sources.getExpansionLineNumber(Location);
+    unsigned const Column = Sources.getExpansionColumnNumber(Location);
+    std::string const Name = D->getNameAsString();
+
+    if (SarifOutput == Format) {
+        Out << ((0 == Count) ? "" : ",\n")
+            << "{\"ruleId\":\"" << FindingNames[Kind] << "\",\"level\":\"warning\",\"message\":{\"text\":";
+        WriteString(Out, FormatMessage(Kind, Name));
+        Out << "},\"locations\":[{\"physicalLocation\":{\"artifactLocation\":{\"uri\":";
+        WriteString(Out, GetFileURI(File));
+        Out << "},\"region\":{\"startLine\":" << Line << ",\"startColumn\":" << Column << "}}"
+            << ",\"logicalLocations\":[{\"name\":";
+        WriteString(Out, Name);
+        Out << ",\"decoratedName\":";
+        WriteString(Out, GenerateUSR(D));
+        Out << "}]}],\"partialFingerprints\":{\"constantine/v1\":\""
+            << llvm::format_hex_no_prefix(GenerateFingerprint(Kind, D), 16) << "\"}"
+            << ",\"properties\":{\"impact\":" << GetImpactScore(Estimate);
+        if (Estimate.Profiled) {
+            Out << ",\"entry-count\":" << Estimate.EntryCount;
+        }
+        if (! Estimate.Instances.empty()) {
+            Out << ",\"instances\":[";
+            for (std::size_t It = 0; It < Estimate.Instances.size(); ++It) {
+                Out << ((0 == It) ? "" : ",");
+                WriteString(Out, GetInstanceName(Estimate.Instances[It].Function));
+            }
+            Out << "]";
+        }
+        Out << "}}";
+    } else {
+        Out << "{\"kind\":\"" << FindingNames[Kind] << "\",\"name\":";
+        WriteString(Out, Name);
+        Out << ",\"usr\":";
+        WriteString(Out, GenerateUSR(D));
+        Out << ",\"fingerprint\":\""
+            << llvm::format_hex_no_prefix(GenerateFingerprint(Kind, D), 16) << "\"";
+        Out << ",\"impact\":{\"score\":" << GetImpactScore(Estimate)
+            << ",\"bytes\":" << Estimate.Bytes
+            << ",\"copies\":" << (Estimate.Copies ? "true" : "false");
+        if (Estimate.LoopsMeasured) {
+            Out << ",\"loop-depth\":" << Estimate.LoopDepth;
+        }
+        if (Estimate.Profiled) {
+            Out << ",\"entry-count\":" << Estimate.EntryCount;
+        }
+        Out << "}";
+        if (! Estimate.Instances.empty()) {
+            Out << ",\"instances\":[";
+            for (std::size_t It = 0; It < Estimate.Instances.size(); ++It) {
+                Out << ((0 == It) ? "" : ",") << "{\"function\":";
+                WriteString(Out, GetInstanceName(Estimate.Instances[It].Function));
+                Out << ",\"type\":";
+                WriteString(Out, Estimate.Instances[It].Type.getAsString());
+                Out << "}";
+            }
+            Out << "]";
+        }
+        Out << ",\"file\":";
+        WriteString(Out, File);
+        Out << ",\"line\":" << Line << ",\"column\":" << Column << "}\n";
+    }
+    ++Count;
+}
+
+bool StructuredFindingWriter::Commit(std::string & Error) {
+    if (SarifOutput == Format) {
+        Out << "\n]}]}\n";
+    }
+    Out.close();
+    Closed = true;
+    if (Out.has_error()) {
+        Out.clear_error();
+        Error = "cannot write '" + TemporaryPath + "'";
+        return false;
+    }
+    if (std::error_code const EC = llvm::sys::fs::rename(TemporaryPath, Path)) {
+        Error = "cannot create '" + Path + "': " + EC.message();
+        return false;
+    }
+    Committed = true;
+    return true;
+}
@@ -0,0 +1,210 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "Options.hpp"
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <clang/AST/AST.h>
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/SourceManager.h>
+#include <llvm/Support/raw_ostream.h>
+
+
+// The kinds of findings of the pseudo constness analysis.
+enum FindingKind
+    { ConstVariableFinding
+    , ConstFunctionFinding
+    , StaticFunctionFinding
+    , ByValueParameterFinding
+    , FindingKindCount
+    };
+
+// The short name of the finding kind, as it appears in the structured
+// outputs. (eg. 'variable-const')
+char const * GetFindingName(FindingKind);
+
+// Stable identifier of the declaration, which is the same in every
+// translation unit. It follows the scheme of the clang USR, but it is a
+// simplified version. (The clang index library is not linked into the
+// compiler, the plugin can not use it.) Local variables are identified by
+// the enclosing function, their name and their ordinal among the same named
+// locals, not by their location. (Lambdas by their ordinal in the function.)
+std::string GenerateUSR(clang::Decl const *);
+
+// Stable identifier of the finding: the hash of the kind, the USR of the
+// declaration and the USR of the enclosing function. (The baseline file
+// is made of these.)
+std::uint64_t GenerateFingerprint(FindingKind, clang::DeclaratorDecl const *);
+
+// A template instantiation which copies a parameter of the given type.
+struct CopyingInstance {
+    clang::FunctionDecl const * Function;
+    clang::QualType Type;
+};
+
+// The estimate of what fixing a finding is worth: the size of the variable
+// (or of the object for methods), whether the value is copied or moved,
+// the deepest loop nesting of its usages, and the entry count of the
+// function from the profile. (The loop depth is valid only when it was
+// measured, the entry count only when the function was found in the given
+// profile.) The by value parameters of templates have the instantiations
+// which are copying them.
+struct Impact {
+    std::uint64_t Bytes;
+    bool Copies;
+    unsigned LoopDepth;
+    bool LoopsMeasured;
+    bool Profiled;
+    std::uint64_t EntryCount;
+    std::vector<CopyingInstance> Instances;
+};
+
+// The type is a class with non-trivial copy or move constructor.
+bool HasNonTrivialCopy(clang::QualType);
+
+// The size of the type in bytes. (Zero when it is not known: dependent or
+// incomplete types.)
+std::uint64_t GetTypeBytes(clang::ASTContext const &, clang::QualType);
+
+// The size and the copies are taken from the declaration, the loop depth
+// is measured by the analysis. (The profile is looked up by the analysis.)
+Impact EstimateImpact(clang::DeclaratorDecl const *, unsigned LoopDepth);
+
+// The single number to rank the findings by. (A loop level is counted as
+// ten iterations, a copy as sixteen accesses of the value, and profiled
+// findings are multiplied by the entry count.)
+std::uint64_t GetImpactScore(Impact const &);
+
+// Receives the findings of the analysis.
+class FindingWriter {
+public:
+    virtual ~FindingWriter()
+    { }
+
+    virtual void Write(FindingKind, clang::DeclaratorDecl const *, Impact const &) = 0;
+};
+
+// Forwards the findings to every registered writer.
+class FindingWriters : public FindingWriter {
+public:
+    FindingWriters();
+
+    void Add(FindingWriter &);
+    void Write(FindingKind, clang::DeclaratorDecl const *, Impact const &) override;
+
+    FindingWriters(FindingWriters const &) = delete;
+    FindingWriters & operator=(FindingWriters const &) = delete;
+
+private:
+    std::vector<FindingWriter *> Writers;
+};
+
+// Collects the findings and forwards them to the target by Flush, in
+// source order and without duplicates. (The analysis produces them in the
+// order of pointer keyed containers, which differs from run to run.) When
+// ranked by impact, the higher scores go first. The findings below the
+// minimum score, and below the minimum entry count are dropped. (Without
+// profile data the entry count is taken as zero.)
+class SortedFindingWriter : public FindingWriter {
+public:
+    explicit SortedFindingWriter(FindingWriter &, bool ByImpact = false, std::uint64_t MinImpact = 0,
+                                 std::uint64_t MinEntryCount = 0);
+
+    void Write(FindingKind, clang::DeclaratorDecl const *, Impact const &) override;
+    void Flush();
+
+    SortedFindingWriter(SortedFindingWriter const &) = delete;
+    SortedFindingWriter & operator=(SortedFindingWriter const &) = delete;
+
+private:
+    struct Finding {
+        FindingKind Kind;
+        clang::DeclaratorDecl const * Decl;
+        Impact Estimate;
+        std::uint64_t Score;
+    };
+
+    FindingWriter & Target;
+    bool const ByImpact;
+    std::uint64_t const MinImpact;
+    std::uint64_t const MinEntryCount;
+    std::vector<Finding> Findings;
+};
+
+// Reports the findings as compiler warnings, with a note on the entry
+// count of the profiled findings, and on every copying instantiation. The
+// custom diagnostic IDs are registered only once.
+class TextFindingWriter : public FindingWriter {
+public:
+    explicit TextFindingWriter(clang::DiagnosticsEngine &);
+
+    void Write(FindingKind, clang::DeclaratorDecl const *, Impact const &) override;
+
+    TextFindingWriter(TextFindingWriter const &) = delete;
+    TextFindingWriter & operator=(TextFindingWriter const &) = delete;
+
+private:
+    clang::DiagnosticsEngine & Engine;
+    unsigned Ids[FindingKindCount];
+    unsigned ProfileId;
+    unsigned InstanceId;
+};
+
+// Streams the findings into a file as JSON lines or as a SARIF log. The
+// content goes into a temporary file through a buffered stream, and moved
+// to its place by Commit. (Readers never see partial content.) When the
+// given path is a directory, the file name is made from the main file name.
+class StructuredFindingWriter : public FindingWriter {
+public:
+    static std::unique_ptr<StructuredFindingWriter> Create(std::string const & Path,
+                                                           OutputFormat,
+                                                           clang::SourceManager const &,
+                                                           std::string & Error);
+    // The path of the file which is written for the given output path.
+    static std::string GetPath(std::string const & Path, OutputFormat, clang::SourceManager const &);
+    ~StructuredFindingWriter() override;
+
+    void Write(FindingKind, clang::DeclaratorDecl const *, Impact const &) override;
+    bool Commit(std::string & Error);
+
+    StructuredFindingWriter(StructuredFindingWriter const &) = delete;
+    StructuredFindingWriter & operator=(StructuredFindingWriter const &) = delete;
+
+private:
+    StructuredFindingWriter(int FD, std::string const & Temporary, std::string const & Path,
+                            OutputFormat, clang::SourceManager const &);
+
+private:
+    OutputFormat const Format;
+    clang::SourceManager const & Sources;
+    std::string const TemporaryPath;
+    std::string const Path;
+    llvm::raw_fd_ostream Out;
+    unsigned Count;
+    bool Closed;
+    bool Committed;
+};
@@ -19,6 +19,9 @@
 
 #pragma once
 
+#include "Statistics.hpp"
+#include "StmtWalker.hpp"
+
 #include <clang/AST/AST.h>
 #include <clang/AST/RecursiveASTVisitor.h>
 
@@ -29,16 +32,30 @@ class IsCXXThisExpr
 public:
     static bool Check(clang::Stmt const * const Stmt) {
         IsCXXThisExpr V;
-        V.TraverseStmt(const_cast<clang::Stmt*>(Stmt));
+        StmtWalker::Walk(V, Stmt);
         return V.Found;
     }
 
     // public visitor method.
+    bool VisitStmt(clang::Stmt const *) {
+        Statistics::Count(ThisSearchNodesVisited);
+        return true;
+    }
+
     bool VisitCXXThisExpr(clang::CXXThisExpr const *) {
         Found = true;
         return true;
     }
 
+    // Dispatch of the iterative walk. It stops at the first match.
+    bool VisitNode(clang::Stmt const * const S) {
+        VisitStmt(S);
+        if (auto const E = clang::dyn_cast<clang::CXXThisExpr const>(S)) {
+            VisitCXXThisExpr(E);
+        }
+        return ! Found;
+    }
+
 private:
     IsCXXThisExpr()
         : clang::RecursiveASTVisitor<IsCXXThisExpr>()
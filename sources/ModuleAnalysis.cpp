@@ -18,61 +18,133 @@
  */
 
 #include "ModuleAnalysis.hpp"
+#include "Constantine.hpp"
 
+#include "Baseline.hpp"
 #include "DeclarationCollector.hpp"
+#include "Findings.hpp"
 #include "ScopeAnalysis.hpp"
 #include "IsCXXThisExpr.hpp"
 #include "IsFromMainModule.hpp"
-
+#include "Profile.hpp"
+#include "ReferenceAnalysis.hpp"
+#include "ResultCache.hpp"
+#include "SourceOrder.hpp"
+#include "Statistics.hpp"
+#include "TimeTrace.hpp"
+
+#include <algorithm>
+#include <cstdint>
 #include <functional>
 #include <iterator>
 #include <map>
 #include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <clang/AST/AST.h>
 #include <clang/AST/RecursiveASTVisitor.h>
 #include <clang/Basic/Diagnostic.h>
+#include <llvm/Support/Format.h>
+#include <llvm/Support/raw_ostream.h>
 
 
 namespace {
 
-// Report function for pseudo constness analysis.
+// Report function for debug functionality.
 template <unsigned N>
-void EmitWarningMessage(clang::DiagnosticsEngine & DE, char const (&Message)[N], clang::DeclaratorDecl const * const V) {
-    unsigned const Id =
-        DE.getCustomDiagID(clang::DiagnosticsEngine::Warning, Message);
+void EmitNoteMessage(clang::DiagnosticsEngine & DE, char const (&Message)[N], clang::DeclaratorDecl const * const V) {
+    unsigned const Id = DE.getCustomDiagID(clang::DiagnosticsEngine::Note, Message);
     clang::DiagnosticBuilder const DB = DE.Report(V->getLocStart(), Id);
     DB << V->getNameAsString();
     DB.setForceEmit();
 }
 
-void ReportVariablePseudoConstness(clang::DiagnosticsEngine & DE, clang::DeclaratorDecl const * const V) {
-    EmitWarningMessage(DE, "variable '%0' could be declared as const", V);
+void ReportVariableDeclaration(clang::DiagnosticsEngine & DE, clang::DeclaratorDecl const * const V) {
+    EmitNoteMessage(DE, "variable '%0' declared here", V);
 }
 
-void ReportFunctionPseudoConstness(clang::DiagnosticsEngine & DE, clang::DeclaratorDecl const * const V) {
-    EmitWarningMessage(DE, "function '%0' could be declared as const", V);
+void ReportFunctionDeclaration(clang::DiagnosticsEngine & DE, clang::DeclaratorDecl const * const V) {
+    EmitNoteMessage(DE, "function '%0' declared here", V);
 }
 
-void ReportFunctionPseudoStaticness(clang::DiagnosticsEngine & DE, clang::DeclaratorDecl const * const V) {
-    EmitWarningMessage(DE, "function '%0' could be declared as static", V);
+// Report function for the reference engine comparison.
+void ReportVerdictMismatch(clang::DiagnosticsEngine & DE, clang::DeclaratorDecl const * const V,
+                           char const * const Kind, char const * const Verdict,
+                           char const * const Engine) {
+    unsigned const Id = DE.getCustomDiagID(clang::DiagnosticsEngine::Warning,
+        "%0 '%1' could be declared as %2 according to the %3 only");
+    clang::DiagnosticBuilder const DB = DE.Report(V->getLocStart(), Id);
+    DB << Kind << V->getNameAsString() << Verdict << Engine;
+    DB.setForceEmit();
 }
 
-// Report function for debug functionality.
+template <typename Set>
+void CompareVerdicts(clang::DiagnosticsEngine & DE, Set const & Expected, Set const & Actual,
+                     char const * const Kind, char const * const Verdict) {
+    for (auto && Entry : SortBySource(Expected)) {
+        if (Actual.end() == Actual.find(Entry)) {
+            ReportVerdictMismatch(DE, Entry, Kind, Verdict, "reference engine");
+        }
+    }
+    for (auto && Entry : SortBySource(Actual)) {
+        if (Expected.end() == Expected.find(Entry)) {
+            ReportVerdictMismatch(DE, Entry, Kind, Verdict, "analysis");
+        }
+    }
+}
+
+// Report function for the top costs.
 template <unsigned N>
-void EmitNoteMessage(clang::DiagnosticsEngine & DE, char const (&Message)[N], clang::DeclaratorDecl const * const V) {
+void ReportCosts(clang::DiagnosticsEngine & DE, char const (&Message)[N], std::vector<Cost> const & Costs) {
     unsigned const Id = DE.getCustomDiagID(clang::DiagnosticsEngine::Note, Message);
-    clang::DiagnosticBuilder const DB = DE.Report(V->getLocStart(), Id);
-    DB << V->getNameAsString();
+    for (auto && Entry : Costs) {
+        std::string Millis;
+        llvm::raw_string_ostream OS(Millis);
+        OS << llvm::format("%.3f", Entry.Seconds * 1000.0);
+        clang::DiagnosticBuilder const DB = DE.Report(Entry.Decl->getLocStart(), Id);
+        DB << Entry.Decl->getQualifiedNameAsString() << OS.str() << std::to_string(Entry.Nodes);
+        DB.setForceEmit();
+    }
+}
+
+// Report function for the structured output.
+void ReportOutputFailure(clang::DiagnosticsEngine & DE, std::string const & Message) {
+    unsigned const Id = DE.getCustomDiagID(clang::DiagnosticsEngine::Warning,
+        "cannot write the findings: %0");
+    clang::DiagnosticBuilder const DB = DE.Report(Id);
+    DB << Message;
     DB.setForceEmit();
 }
 
-void ReportVariableDeclaration(clang::DiagnosticsEngine & DE, clang::DeclaratorDecl const * const V) {
-    EmitNoteMessage(DE, "variable '%0' declared here", V);
+// Report function for the baseline. The findings are not filtered then.
+void ReportBaselineFailure(clang::DiagnosticsEngine & DE, std::string const & Message) {
+    unsigned const Id = DE.getCustomDiagID(clang::DiagnosticsEngine::Warning,
+        "cannot read the baseline: %0");
+    clang::DiagnosticBuilder const DB = DE.Report(Id);
+    DB << Message;
+    DB.setForceEmit();
 }
 
-void ReportFunctionDeclaration(clang::DiagnosticsEngine & DE, clang::DeclaratorDecl const * const V) {
-    EmitNoteMessage(DE, "function '%0' declared here", V);
+// Report function for the profile. The findings are not annotated then.
+void ReportProfileFailure(clang::DiagnosticsEngine & DE, std::string const & Message) {
+    unsigned const Id = DE.getCustomDiagID(clang::DiagnosticsEngine::Warning,
+        "cannot read the profile: %0");
+    clang::DiagnosticBuilder const DB = DE.Report(Id);
+    DB << Message;
+    DB.setForceEmit();
+}
+
+// Report function for the work budget check.
+void ReportBudgetExceeded(clang::DiagnosticsEngine & DE, char const * const Name,
+                          std::uint64_t const Value, std::uint64_t const Limit) {
+    unsigned const Id = DE.getCustomDiagID(clang::DiagnosticsEngine::Warning,
+        "constantine work counter '%0' is %1, over the budget of %2");
+    clang::DiagnosticBuilder const DB = DE.Report(Id);
+    DB << Name << std::to_string(Value) << std::to_string(Limit);
+    DB.setForceEmit();
 }
 
 
@@ -87,13 +159,62 @@ bool IsJustAMethod(clang::CXXMethodDecl const * const F) {
 }
 
 
+// Instantiated declarations to the declarations of their pattern.
+typedef std::map<clang::DeclaratorDecl const *, clang::DeclaratorDecl const *> VariableMap;
+
+// The deepest loop nesting where the variables were used, over all
+// analysed functions.
+typedef std::map<clang::DeclaratorDecl const *, unsigned> LoopDepthMap;
+
+unsigned GetLoopDepth(LoopDepthMap const & Depths, clang::DeclaratorDecl const * const V) {
+    auto const It = Depths.find(V);
+    return (Depths.end() == It) ? 0 : It->second;
+}
+
+// The instantiated variables (or fields) are matched to the pattern by
+// name and by the order of declaration. (The instantiation keeps both.)
+// Names with different number of declarations (parameter pack expansions)
+// are not matched, the pattern declarations are returned as unmatched.
+template <typename Declaration>
+void MatchDeclarations(clang::DeclContext const * const Instance,
+                       clang::DeclContext const * const Pattern,
+                       VariableMap & Matched,
+                       Variables & Unmatched) {
+    typedef std::map<std::string, std::vector<clang::DeclaratorDecl const *>> ByName;
+    auto const Collect = [](clang::DeclContext const * const Context) {
+        ByName Result;
+        for (auto const & It : Context->decls()) {
+            if (auto const D = clang::dyn_cast<Declaration const>(It)) {
+                Result[D->getNameAsString()].push_back(D);
+            }
+        }
+        return Result;
+    };
+    ByName const Instances = Collect(Instance);
+    ByName const Patterns = Collect(Pattern);
+    for (auto && Entry : Patterns) {
+        auto const It = Instances.find(Entry.first);
+        if ((Instances.end() == It) || (It->second.size() != Entry.second.size())) {
+            Unmatched.insert(Entry.second.begin(), Entry.second.end());
+            continue;
+        }
+        for (std::size_t Index = 0; Index < Entry.second.size(); ++Index) {
+            Matched[It->second[Index]] = Entry.second[Index];
+        }
+    }
+}
+
+
 // Pseudo constness analysis detects what variable can be declare as const.
 // This analysis runs through multiple scopes. We need to store the state of
 // the ongoing analysis. Once the variable was changed can't be const.
 class PseudoConstnessAnalysisState {
 public:
-    PseudoConstnessAnalysisState()
-        : Candidates()
+    // Without alias tracking, the change of a reference does not change
+    // the variables which it might refer to.
+    explicit PseudoConstnessAnalysisState(bool const TrackAliases)
+        : TrackAliases(TrackAliases)
+        , Candidates()
         , Changed()
     { }
 
@@ -103,20 +224,64 @@ public:
 
     void Eval(ScopeAnalysis const & Analysis, clang::DeclaratorDecl const * const V) {
         if (Analysis.WasChanged(V)) {
+            if (! TrackAliases) {
+                RegisterChange(V);
+                return;
+            }
             for (auto && Variable: GetReferedVariables(V)) {
                 RegisterChange(Variable);
             }
         } else if (Changed.end() == Changed.find(V)) {
-            if (! IsConst(*V)) {
-                Candidates.insert(V);
+            if ((! IsConst(*V)) && Candidates.insert(V).second) {
+                Statistics::Count(CandidatesInserted);
             }
         }
     }
 
-    void GenerateReports(clang::DiagnosticsEngine & DE) const {
+    // The changes of a template instantiation are registered on the
+    // variables of the pattern. (Variables which are not in the map are
+    // not instantiated, those are registered as they are.)
+    void EvalInstance(ScopeAnalysis const & Analysis,
+                      clang::DeclaratorDecl const * const V,
+                      VariableMap const & Patterns) {
+        if (! Analysis.WasChanged(V))
+            return;
+
+        auto const Register = [this, &Patterns](clang::DeclaratorDecl const * const Variable) {
+            auto const It = Patterns.find(Variable);
+            RegisterChange((Patterns.end() == It) ? Variable : It->second);
+        };
+        if (! TrackAliases) {
+            Register(V);
+            return;
+        }
+        for (auto && Variable: GetReferedVariables(V)) {
+            Register(Variable);
+        }
+    }
+
+    // The variable can not be a candidate any more.
+    void Exclude(clang::DeclaratorDecl const * const V) {
+        RegisterChange(V);
+    }
+
+    bool IsExcluded(clang::DeclaratorDecl const * const V) const {
+        return Changed.end() != Changed.find(V);
+    }
+
+    std::size_t GetFootprint() const {
+        return EstimateFootprint(Candidates) + EstimateFootprint(Changed);
+    }
+
+    Variables const & GetCandidates() const {
+        return Candidates;
+    }
+
+    template <typename Estimator>
+    void GenerateReports(FindingWriter & Writer, Estimator const & Estimate) const {
         for (auto && Variable: Candidates) {
             if (IsFromMainModule(Variable)) {
-                ReportVariablePseudoConstness(DE, Variable);
+                Writer.Write(ConstVariableFinding, Variable, Estimate(Variable));
             }
         }
     }
@@ -127,85 +292,180 @@ private:
     }
 
     void RegisterChange(clang::DeclaratorDecl const * const V) {
-        Candidates.erase(V);
+        Statistics::Count(CandidatesErased, Candidates.erase(V));
         Changed.insert(V);
     }
 
 private:
+    bool const TrackAliases;
     Variables Candidates;
     Variables Changed;
 };
 
 
-// Base class for analysis. Implement function declaration visitor, which visit
-// functions only once. The traversal algorithm is calling all methods, which is
-// not desired. In case of a CXXMethodDecl, it was calling the VisitFunctionDecl
-// and the VisitCXXMethodDecl as well. This dispatching is reworked in this class.
+// Base class for analysis passes. The passes are run by the module visitor
+// on every function definition. The scope analysis of the function is shared
+// between the passes, the facts are computed only once.
+class AnalysisPass {
+public:
+    typedef std::unique_ptr<AnalysisPass> Ptr;
+    static AnalysisPass::Ptr CreatePass(Target, Options const &, Profile const *,
+                                        clang::DiagnosticsEngine &, FindingWriter &);
+
+    virtual ~AnalysisPass()
+    { }
+
+public:
+    // interface methods with different visibilities.
+    virtual void Dump(clang::DiagnosticsEngine &) const = 0;
+
+    // Only the pseudo constness analysis has verdicts.
+    virtual bool GetVerdicts(Verdicts &) const {
+        return false;
+    }
+
+    virtual void OnFunctionDecl(clang::FunctionDecl const *, ScopeAnalysis &) = 0;
+    virtual void OnCXXMethodDecl(clang::CXXMethodDecl const *, ScopeAnalysis &) = 0;
+
+    // Template instantiations are visited on the thorough level only. The
+    // passes are reporting the patterns, instantiations are ignored unless
+    // the pass merges those into the pattern.
+    virtual void OnInstantiation(clang::FunctionDecl const *, clang::FunctionDecl const *, ScopeAnalysis &)
+    { }
+};
+
+
+// Implement function declaration visitor, which visit functions only once.
+// The traversal algorithm is calling all methods, which is not desired. In
+// case of a CXXMethodDecl, it was calling the VisitFunctionDecl and the
+// VisitCXXMethodDecl as well. This dispatching is reworked in this class.
 class ModuleVisitor
     : public clang::RecursiveASTVisitor<ModuleVisitor> {
 public:
-    typedef std::unique_ptr<ModuleVisitor> Ptr;
-    static ModuleVisitor::Ptr CreateVisitor(Target);
-
-    virtual ~ModuleVisitor()
+    // The passes are added by the caller. (The instantiations are visited
+    // on the thorough level.)
+    explicit ModuleVisitor(AnalysisLevel const Level)
+        : clang::RecursiveASTVisitor<ModuleVisitor>()
+        , Instantiations(ThoroughLevel == Level)
+        , Passes()
     { }
 
+    ModuleVisitor(Options const & Config, Profile const * const Counts,
+                  clang::DiagnosticsEngine & DE, FindingWriter & Writer)
+        : clang::RecursiveASTVisitor<ModuleVisitor>()
+        , Instantiations(ThoroughLevel == Config.Level)
+        , Passes()
+    {
+        for (auto && Current : Config.Debug) {
+            Passes.push_back(AnalysisPass::CreatePass(Current, Config, Counts, DE, Writer));
+        }
+    }
+
+    // The passes run in the order of adding.
+    void AddPass(AnalysisPass::Ptr Pass) {
+        Passes.push_back(std::move(Pass));
+    }
+
+    ModuleVisitor(ModuleVisitor const &) = delete;
+    ModuleVisitor & operator=(ModuleVisitor const &) = delete;
+
 public:
+    bool shouldVisitTemplateInstantiations() const {
+        return Instantiations;
+    }
+
     // public visitor method.
+    bool VisitDecl(clang::Decl const *) {
+        Statistics::Count(NodesVisited);
+        return true;
+    }
+
+    bool VisitStmt(clang::Stmt const *) {
+        Statistics::Count(NodesVisited);
+        return true;
+    }
+
     bool VisitFunctionDecl(clang::FunctionDecl const * const F) {
         if (! (F->isThisDeclarationADefinition()))
             return true;
+        // the parser might have skipped the body.
+        if (F->hasSkippedBody())
+            return true;
 
-        if (auto const D = clang::dyn_cast<clang::CXXMethodDecl const>(F)) {
-            OnCXXMethodDecl(D);
-        } else {
-            OnFunctionDecl(F);
+        Statistics::Count(FunctionsAnalysed);
+
+        ScopeAnalysis Analysis = ScopeAnalysis::AnalyseThis(*(F->getBody()));
+        if (Instantiations && F->isTemplateInstantiation()) {
+            if (auto const Pattern = F->getTemplateInstantiationPattern()) {
+                for (auto && Pass : Passes) {
+                    Pass->OnInstantiation(F, Pattern, Analysis);
+                }
+                return true;
+            }
+        }
+        for (auto && Pass : Passes) {
+            if (auto const D = clang::dyn_cast<clang::CXXMethodDecl const>(F)) {
+                Pass->OnCXXMethodDecl(D, Analysis);
+            } else {
+                Pass->OnFunctionDecl(F, Analysis);
+            }
         }
         return true;
     }
 
 public:
-    // interface methods with different visibilities.
-    virtual void Dump(clang::DiagnosticsEngine &) const = 0;
+    void Dump(clang::DiagnosticsEngine & DE) const {
+        for (auto && Pass : Passes) {
+            Pass->Dump(DE);
+        }
+    }
+
+    bool GetVerdicts(Verdicts & Out) const {
+        for (auto && Pass : Passes) {
+            if (Pass->GetVerdicts(Out))
+                return true;
+        }
+        return false;
+    }
 
-protected:
-    virtual void OnFunctionDecl(clang::FunctionDecl const *) = 0;
-    virtual void OnCXXMethodDecl(clang::CXXMethodDecl const *) = 0;
+private:
+    bool const Instantiations;
+    std::vector<AnalysisPass::Ptr> Passes;
 };
 
 
 class DebugFunctionDeclarations
-    : public ModuleVisitor {
-protected:
-    void OnFunctionDecl(clang::FunctionDecl const * const F) override {
+    : public AnalysisPass {
+public:
+    void OnFunctionDecl(clang::FunctionDecl const * const F, ScopeAnalysis &) override {
         Functions.insert(F);
     }
 
-    void OnCXXMethodDecl(clang::CXXMethodDecl const * const F) override {
+    void OnCXXMethodDecl(clang::CXXMethodDecl const * const F, ScopeAnalysis &) override {
         Functions.insert(F);
     }
 
     void Dump(clang::DiagnosticsEngine & DE) const override {
-        for (auto && Function: Functions) {
+        for (auto && Function: SortBySource(Functions)) {
             ReportFunctionDeclaration(DE, Function);
         }
     }
 
-protected:
+private:
     std::set<clang::FunctionDecl const *> Functions;
 };
 
 
 class DebugVariableDeclarations
-    : public ModuleVisitor {
-private:
-    void OnFunctionDecl(clang::FunctionDecl const * const F) override {
+    : public AnalysisPass {
+public:
+    void OnFunctionDecl(clang::FunctionDecl const * const F, ScopeAnalysis &) override {
         for (auto && Variable: GetVariablesFromContext(F)) {
             Results.insert(Variable);
         }
     }
 
-    void OnCXXMethodDecl(clang::CXXMethodDecl const * const F) override {
+    void OnCXXMethodDecl(clang::CXXMethodDecl const * const F, ScopeAnalysis &) override {
         for (auto && Variable: GetVariablesFromContext(F, IsJustAMethod(F))) {
             Results.insert(Variable);
         }
@@ -217,7 +477,7 @@ private:
     }
 
     void Dump(clang::DiagnosticsEngine & DE) const override {
-        for (auto && Result: Results) {
+        for (auto && Result: SortBySource(Results)) {
             ReportVariableDeclaration(DE, Result);
         }
     }
@@ -227,76 +487,251 @@ private:
 };
 
 
+// The usage debug passes report while the function facts are available,
+// instead of keeping those until the end of the traversal.
 class DebugVariableUsages
-    : public DebugFunctionDeclarations {
-private:
-    static void ReportVariableUsage(clang::DiagnosticsEngine & DE, clang::FunctionDecl const * const F) {
-        ScopeAnalysis const & Analysis = ScopeAnalysis::AnalyseThis(*(F->getBody()));
-        Analysis.DebugReferenced(DE);
+    : public AnalysisPass {
+public:
+    explicit DebugVariableUsages(clang::DiagnosticsEngine & DE)
+        : AnalysisPass()
+        , Reporter(DE)
+    { }
+
+    void OnFunctionDecl(clang::FunctionDecl const *, ScopeAnalysis & Analysis) override {
+        Analysis.DebugReferenced(Reporter);
     }
 
-    void Dump(clang::DiagnosticsEngine & DE) const {
-        for (auto && Function: Functions) {
-            ReportVariableUsage(DE, Function);
-        }
+    void OnCXXMethodDecl(clang::CXXMethodDecl const *, ScopeAnalysis & Analysis) override {
+        Analysis.DebugReferenced(Reporter);
     }
+
+    void Dump(clang::DiagnosticsEngine &) const override
+    { }
+
+private:
+    clang::DiagnosticsEngine & Reporter;
 };
 
 
 class DebugVariableChanges
-    : public DebugFunctionDeclarations {
-private:
-    static void ReportVariableUsage(clang::DiagnosticsEngine & DE, clang::FunctionDecl const * const F) {
-        ScopeAnalysis const & Analysis = ScopeAnalysis::AnalyseThis(*(F->getBody()));
-        Analysis.DebugChanged(DE);
+    : public AnalysisPass {
+public:
+    explicit DebugVariableChanges(clang::DiagnosticsEngine & DE)
+        : AnalysisPass()
+        , Reporter(DE)
+    { }
+
+    void OnFunctionDecl(clang::FunctionDecl const *, ScopeAnalysis & Analysis) override {
+        Analysis.DebugChanged(Reporter);
     }
 
-    void Dump(clang::DiagnosticsEngine & DE) const {
-        for (auto && Function: Functions) {
-            ReportVariableUsage(DE, Function);
-        }
+    void OnCXXMethodDecl(clang::CXXMethodDecl const *, ScopeAnalysis & Analysis) override {
+        Analysis.DebugChanged(Reporter);
     }
+
+    void Dump(clang::DiagnosticsEngine &) const override
+    { }
+
+private:
+    clang::DiagnosticsEngine & Reporter;
 };
 
 
 class AnalyseVariableUsage
-    : public ModuleVisitor {
+    : public AnalysisPass {
+public:
+    // The loop depths are measured only when the impact of the findings
+    // is used, it needs the usages of every function. The profile is
+    // optional.
+    AnalyseVariableUsage(FindingWriter & Output, AnalysisLevel const Level, bool const MeasureImpact,
+                         Profile const * const Counts)
+        : AnalysisPass()
+        , Level(Level)
+        , MeasureImpact(MeasureImpact)
+        , Counts(Counts)
+        , Writer(Output)
+        , State(FastLevel != Level)
+        , ConstCandidates()
+        , StaticCandidates()
+        , InstanceVerdicts()
+        , Settled()
+        , Summaries()
+        , SummariesFootprint(0)
+        , LoopDepths()
+    { }
+
 private:
-    void OnFunctionDecl(clang::FunctionDecl const * const F) override {
-        ScopeAnalysis const & Analysis = ScopeAnalysis::AnalyseThis(*(F->getBody()));
-        for (auto && Variable: GetVariablesFromContext(F)) {
-            State.Eval(Analysis, Variable);
+    // The verdicts of a method, ordered by strength. (Merging takes the
+    // weaker one.)
+    enum MethodVerdict
+        { NoVerdict
+        , ConstVerdict
+        , StaticVerdict
+        };
+
+    // The record wide declarations, which are the same for every method.
+    struct RecordSummary {
+        Variables Fields;
+        Methods Members;
+    };
+
+    RecordSummary const & GetSummary(clang::CXXRecordDecl const * const R) {
+        auto const It = Summaries.find(R);
+        if (Summaries.end() != It)
+            return It->second;
+
+        TraceScope const Trace("Constantine record summary",
+            [R]() { return R->getQualifiedNameAsString(); });
+        Statistics::CostScope const Measure(RecordSummaryCost, R);
+        RecordSummary Summary;
+        Summary.Fields = GetVariablesFromRecord(R);
+        Summary.Members = GetMethodsFromRecord(R);
+        if (Statistics::IsTrackingFootprint()) {
+            std::size_t const Bytes = sizeof(decltype(Summaries)::value_type) + TreeNodeOverhead
+                + EstimateFootprint(Summary.Fields) + EstimateFootprint(Summary.Members);
+            SummariesFootprint += Bytes;
+            Statistics::Attribute(RecordSummariesFootprint, R->getQualifiedNameAsString(), Bytes);
+            Statistics::SetFootprint(RecordSummariesFootprint, SummariesFootprint);
         }
+        return Summaries.insert(std::make_pair(R, std::move(Summary))).first->second;
     }
 
-    void OnCXXMethodDecl(clang::CXXMethodDecl const * const F) override {
+    // Account the memory held after the analysis of a function. The usage
+    // maps are released after this point, the other structures are kept.
+    void Checkpoint(clang::FunctionDecl const * const F, ScopeAnalysis const & Analysis) {
+        if (Statistics::IsTrackingFootprint()) {
+            std::size_t const Bytes = Analysis.GetFootprint();
+            Statistics::Attribute(UsageMapsFootprint, F->getQualifiedNameAsString(), Bytes);
+            Statistics::SetFootprint(UsageMapsFootprint, Bytes);
+            Statistics::SetFootprint(CandidateSetsFootprint, State.GetFootprint()
+                + EstimateFootprint(ConstCandidates) + EstimateFootprint(StaticCandidates));
+            Statistics::Checkpoint();
+            Statistics::SetFootprint(UsageMapsFootprint, 0);
+        }
+    }
+
+    void OnFunctionDecl(clang::FunctionDecl const * const F, ScopeAnalysis & Analysis) override {
+        TraceScope const Trace("Constantine function",
+            [F]() { return F->getQualifiedNameAsString(); });
+        Statistics::CostScope const Measure(FunctionCost, F);
+        EvalLocals(F, GetVariablesFromContext(F), Analysis);
+    }
+
+    void OnCXXMethodDecl(clang::CXXMethodDecl const * const F, ScopeAnalysis & Analysis) override {
+        TraceScope const Trace("Constantine function",
+            [F]() { return F->getQualifiedNameAsString(); });
+        Statistics::CostScope const Measure(FunctionCost, F);
+        // the fast level does not look at the record.
+        if (FastLevel == Level) {
+            EvalLocals(F, GetVariablesFromContext(F, IsJustAMethod(F)), Analysis);
+            return;
+        }
         clang::CXXRecordDecl const * const Parent = F->getParent();
         clang::CXXRecordDecl const * const RecordDecl =
             Parent->hasDefinition() ? Parent->getDefinition() : Parent->getCanonicalDecl();
-        Variables const MemberVariables = GetMemberVariablesAndReferences(RecordDecl, F);
+        RecordSummary const & Summary = GetSummary(RecordDecl);
+        Variables const MemberVariables = GetMemberVariablesAndReferences(Summary.Fields, F);
+        Variables const Locals = GetVariablesFromContext(F, IsJustAMethod(F));
+        // only these variables are asked about changes.
+        if (ThoroughLevel != Level) {
+            Variables Interest = Locals;
+            Interest.insert(MemberVariables.begin(), MemberVariables.end());
+            Analysis.LimitChangesTo(Interest);
+        }
         // check variables first,
-        ScopeAnalysis const & Analysis = ScopeAnalysis::AnalyseThis(*(F->getBody()));
-        for (auto && Variable: GetVariablesFromContext(F, IsJustAMethod(F))) {
+        for (auto && Variable: Locals) {
             State.Eval(Analysis, Variable);
         }
         for (auto && Variable: MemberVariables) {
             State.Eval(Analysis, Variable);
         }
         // then check the method itself.
+        EvalMethod(F, Summary, MemberVariables, Analysis);
+        EvalAllChanges(Analysis);
+        MeasureLoopDepths(Locals, Analysis);
+        MeasureLoopDepths(MemberVariables, Analysis);
+        Checkpoint(F, Analysis);
+    }
+
+    void EvalLocals(clang::FunctionDecl const * const F,
+                    Variables const & Locals,
+                    ScopeAnalysis & Analysis) {
+        if (ThoroughLevel != Level) {
+            Analysis.LimitChangesTo(Locals);
+        }
+        for (auto && Variable: Locals) {
+            State.Eval(Analysis, Variable);
+        }
+        EvalAllChanges(Analysis);
+        MeasureLoopDepths(Locals, Analysis);
+        Checkpoint(F, Analysis);
+    }
+
+    // Only the candidates are measured, the changed variables are never
+    // reported. (Fields are measured in every method, the deepest wins.)
+    void MeasureLoopDepths(Variables const & Measured, ScopeAnalysis const & Analysis) {
+        if (! MeasureImpact)
+            return;
+        for (auto && Variable: Measured) {
+            if (State.IsExcluded(Variable))
+                continue;
+            unsigned const Depth = Analysis.GetLoopDepth(Variable);
+            if (0 != Depth) {
+                unsigned & Deepest = LoopDepths[Variable];
+                Deepest = std::max(Deepest, Depth);
+            }
+        }
+    }
+
+    // The thorough level registers every change of the function, not only
+    // the changes of its own variables. (Fields which are changed by free
+    // functions or by methods of other records are not candidates then.)
+    void EvalAllChanges(ScopeAnalysis const & Analysis) {
+        if (ThoroughLevel != Level)
+            return;
+        for (auto && Entry: Analysis.GetAllChanges()) {
+            State.Eval(Analysis, Entry.first);
+        }
+    }
+
+    void EvalMethod(clang::CXXMethodDecl const * const F,
+                    RecordSummary const & Summary,
+                    Variables const & MemberVariables,
+                    ScopeAnalysis const & Analysis) {
+        switch (JudgeMethod(F, Summary, MemberVariables, Analysis)) {
+        case StaticVerdict :
+            StaticCandidates.insert(F);
+            Statistics::Count(CandidatesInserted);
+            break;
+        case ConstVerdict :
+            if (! F->isConst()) {
+                ConstCandidates.insert(F);
+                Statistics::Count(CandidatesInserted);
+            }
+            break;
+        case NoVerdict :
+            break;
+        }
+    }
+
+    MethodVerdict JudgeMethod(clang::CXXMethodDecl const * const F,
+                              RecordSummary const & Summary,
+                              Variables const & MemberVariables,
+                              ScopeAnalysis const & Analysis) const {
         if ((! F->isVirtual()) &&
             (! F->isStatic()) &&
             F->isUserProvided() &&
             IsJustAMethod(F)
         ) {
-            Methods const MemberFunctions = GetMethodsFromRecord(RecordDecl);
+            Methods const & MemberFunctions = Summary.Members;
             for (auto && Variable: MemberVariables) {
                 if (Analysis.WasChanged(Variable)) {
-                    return;
+                    return NoVerdict;
                 }
             }
             for (auto && Function: MemberFunctions) {
                 if (IsMutatingMethod(Function) && Analysis.WasReferenced(Function)) {
-                    return;
+                    return NoVerdict;
                 }
             }
             // if it looks const, it might be even static..
@@ -311,28 +746,193 @@ private:
                     NotMutateMember = false;
                 }
             }
-            if (NotMutateMember) {
-                StaticCandidates.insert(F);
-            } else if (! F->isConst()) {
-                ConstCandidates.insert(F);
+            return NotMutateMember ? StaticVerdict : ConstVerdict;
+        }
+        return NoVerdict;
+    }
+
+    // The changes of an instantiation are merged into the pattern: the
+    // variables changed are excluded, the method verdict can only get
+    // weaker. Instantiations of a settled pattern are not analysed.
+    void OnInstantiation(clang::FunctionDecl const * const F,
+                         clang::FunctionDecl const * const Pattern,
+                         ScopeAnalysis & Analysis) override {
+        if (IsSettled(Pattern)) {
+            Statistics::Count(InstantiationsSkipped);
+            return;
+        }
+        TraceScope const Trace("Constantine instantiation",
+            [F]() { return F->getQualifiedNameAsString(); });
+        Statistics::CostScope const Measure(FunctionCost, F);
+        VariableMap Patterns;
+        Variables Unmatched;
+        MatchDeclarations<clang::VarDecl>(F, Pattern, Patterns, Unmatched);
+
+        auto const M = clang::dyn_cast<clang::CXXMethodDecl const>(F);
+        RecordSummary const * Summary = nullptr;
+        Variables MemberVariables;
+        if (M && (FastLevel != Level)) {
+            clang::CXXRecordDecl const * const Parent = M->getParent();
+            clang::CXXRecordDecl const * const RecordDecl =
+                Parent->hasDefinition() ? Parent->getDefinition() : Parent->getCanonicalDecl();
+            Summary = &GetSummary(RecordDecl);
+            MemberVariables = GetMemberVariablesAndReferences(Summary->Fields, M);
+            for (auto && Base : AllBase(RecordDecl)) {
+                if (auto const BasePattern = Base->getTemplateInstantiationPattern()) {
+                    MatchDeclarations<clang::FieldDecl>(Base, BasePattern, Patterns, Unmatched);
+                }
+            }
+        }
+        for (auto && Variable: Unmatched) {
+            State.Exclude(Variable);
+        }
+        for (auto && Entry: Analysis.GetAllChanges()) {
+            State.EvalInstance(Analysis, Entry.first, Patterns);
+        }
+        CollectCopies(F, Patterns);
+        if (Summary) {
+            auto const PatternMethod = clang::cast<clang::CXXMethodDecl const>(Pattern);
+            MethodVerdict const Verdict = JudgeMethod(M, *Summary, MemberVariables, Analysis);
+            auto const It = InstanceVerdicts.insert(std::make_pair(PatternMethod, Verdict)).first;
+            It->second = std::min(It->second, Verdict);
+        }
+        Checkpoint(F, Analysis);
+    }
+
+    // The parameters of the pattern which are taken by value with dependent
+    // type, and the instantiation copies a large (bigger than two pointers)
+    // or non-trivially copyable type there.
+    void CollectCopies(clang::FunctionDecl const * const F, VariableMap const & Patterns) {
+        clang::ASTContext const & Ctx = F->getASTContext();
+        std::uint64_t const Large = 2 * GetTypeBytes(Ctx, Ctx.VoidPtrTy);
+        for (unsigned It = 0, End = F->getNumParams(); It != End; ++It) {
+            clang::ParmVarDecl const * const Parameter = F->getParamDecl(It);
+            auto const Pattern = Patterns.find(Parameter);
+            if (Patterns.end() == Pattern)
+                continue;
+            clang::QualType const PatternType = Pattern->second->getType();
+            clang::QualType const Type = Parameter->getType();
+            if ((! PatternType->isDependentType()) || PatternType->isReferenceType() || Type->isReferenceType())
+                continue;
+            if (HasNonTrivialCopy(Type) || (Large < GetTypeBytes(Ctx, Type))) {
+                CopiedParameters[Pattern->second].push_back(CopyingInstance { F, Type });
             }
         }
     }
 
-    void Dump(clang::DiagnosticsEngine & DE) const override {
-        State.GenerateReports(DE);
+    // Every variable of the pattern (and every field of its record) was
+    // changed already, and an instantiation of the method had no verdict.
+    // Further instantiations can not change the verdicts then. (These do
+    // not depend on the order of visiting the pattern and instantiations.)
+    bool IsSettled(clang::FunctionDecl const * const Pattern) {
+        if (Settled.end() != Settled.find(Pattern))
+            return true;
+
+        for (auto && Variable: GetVariablesFromContext(Pattern)) {
+            if (! State.IsExcluded(Variable))
+                return false;
+        }
+        if (auto const M = clang::dyn_cast<clang::CXXMethodDecl const>(Pattern)) {
+            auto const It = InstanceVerdicts.find(M);
+            if ((InstanceVerdicts.end() == It) || (NoVerdict != It->second))
+                return false;
+            clang::CXXRecordDecl const * const Parent = M->getParent();
+            clang::CXXRecordDecl const * const RecordDecl =
+                Parent->hasDefinition() ? Parent->getDefinition() : Parent->getCanonicalDecl();
+            for (auto && Variable: GetSummary(RecordDecl).Fields) {
+                if (! State.IsExcluded(Variable))
+                    return false;
+            }
+        }
+        Settled.insert(Pattern);
+        return true;
+    }
+
+    // The methods are looked up in the profile by themselves, the variables
+    // by their enclosing function. (Fields have no entry count.)
+    Impact GetImpact(clang::DeclaratorDecl const * const D) const {
+        Impact Result = EstimateImpact(D, GetLoopDepth(LoopDepths, D));
+        Result.LoopsMeasured = MeasureImpact;
+        if (Counts) {
+            auto const F = clang::isa<clang::FunctionDecl const>(D)
+                ? clang::cast<clang::FunctionDecl const>(D)
+                : clang::dyn_cast_or_null<clang::FunctionDecl const>(D->getParentFunctionOrMethod());
+            Result.Profiled = F && Counts->GetEntryCount(F, Result.EntryCount);
+        }
+        return Result;
+    }
+
+    // The copy cost of the parameter is the worst of its instantiations.
+    Impact GetCopyImpact(clang::DeclaratorDecl const * const P,
+                         std::vector<CopyingInstance> const & Instances) const {
+        Impact Result = GetImpact(P);
+        for (auto && Instance: Instances) {
+            Result.Bytes = std::max(Result.Bytes, GetTypeBytes(P->getASTContext(), Instance.Type));
+            Result.Copies = Result.Copies || HasNonTrivialCopy(Instance.Type);
+        }
+        Result.Instances = Instances;
+        return Result;
+    }
+
+    // The verdict of the pattern, weakened by the instantiations.
+    MethodVerdict MergeVerdict(clang::CXXMethodDecl const * const F, MethodVerdict const Verdict) const {
+        auto const It = InstanceVerdicts.find(F);
+        return (InstanceVerdicts.end() == It) ? Verdict : std::min(Verdict, It->second);
+    }
+
+public:
+    // The findings go to the writer, not to the diagnostic engine.
+    void Dump(clang::DiagnosticsEngine &) const override {
+        Report();
+    }
+
+    void Report() const {
+        TraceScope const Trace("Constantine report",
+            []() { return std::string(); });
+        State.GenerateReports(Writer,
+            [this](clang::DeclaratorDecl const * const D) { return GetImpact(D); });
         for (auto && Candidate: ConstCandidates) {
-            if (IsFromMainModule(Candidate)) {
-                ReportFunctionPseudoConstness(DE, Candidate);
+            if (IsFromMainModule(Candidate) && (ConstVerdict == MergeVerdict(Candidate, ConstVerdict))) {
+                Writer.Write(ConstFunctionFinding, Candidate, GetImpact(Candidate));
             }
         }
         for (auto && Candidate: StaticCandidates) {
-            if (IsFromMainModule(Candidate)) {
-                ReportFunctionPseudoStaticness(DE, Candidate);
+            if (! IsFromMainModule(Candidate))
+                continue;
+            switch (MergeVerdict(Candidate, StaticVerdict)) {
+            case StaticVerdict :
+                Writer.Write(StaticFunctionFinding, Candidate, GetImpact(Candidate));
+                break;
+            case ConstVerdict :
+                if (! Candidate->isConst()) {
+                    Writer.Write(ConstFunctionFinding, Candidate, GetImpact(Candidate));
+                }
+                break;
+            case NoVerdict :
+                break;
+            }
+        }
+        // the parameters which are changed can not be const references.
+        for (auto && Entry: CopiedParameters) {
+            if (IsFromMainModule(Entry.first) && (! State.IsExcluded(Entry.first))) {
+                Writer.Write(ByValueParameterFinding, Entry.first, GetCopyImpact(Entry.first, Entry.second));
             }
         }
     }
 
+    // The reference engine implements the default level only.
+    bool GetVerdicts(Verdicts & Out) const override {
+        if (DefaultLevel != Level)
+            return false;
+        std::copy_if(State.GetCandidates().begin(), State.GetCandidates().end(),
+            std::inserter(Out.ConstVariables, Out.ConstVariables.end()), IsFromMainModule);
+        std::copy_if(ConstCandidates.begin(), ConstCandidates.end(),
+            std::inserter(Out.ConstMethods, Out.ConstMethods.end()), IsFromMainModule);
+        std::copy_if(StaticCandidates.begin(), StaticCandidates.end(),
+            std::inserter(Out.StaticMethods, Out.StaticMethods.end()), IsFromMainModule);
+        return true;
+    }
+
 private:
     inline
     static bool IsMutatingMethod(clang::CXXMethodDecl const * const F) {
@@ -345,38 +945,280 @@ private:
     }
 
 private:
+    AnalysisLevel const Level;
+    bool const MeasureImpact;
+    Profile const * const Counts;
+    FindingWriter & Writer;
     PseudoConstnessAnalysisState State;
     Methods ConstCandidates;
     Methods StaticCandidates;
+    std::map<clang::CXXMethodDecl const *, MethodVerdict> InstanceVerdicts;
+    std::set<clang::FunctionDecl const *> Settled;
+    std::map<clang::CXXRecordDecl const *, RecordSummary> Summaries;
+    std::size_t SummariesFootprint;
+    LoopDepthMap LoopDepths;
+    std::map<clang::DeclaratorDecl const *, std::vector<CopyingInstance>> CopiedParameters;
+};
+
+
+// Copies the facts of every function, for the library interface.
+class CollectFunctionFacts
+    : public AnalysisPass {
+public:
+    explicit CollectFunctionFacts(std::vector<FunctionFacts> & Out)
+        : AnalysisPass()
+        , Results(Out)
+    { }
+
+    void OnFunctionDecl(clang::FunctionDecl const * const F, ScopeAnalysis & Analysis) override {
+        Results.push_back(FunctionFacts { F, Analysis.GetAllChanges(), Analysis.GetAllUsages() });
+    }
+
+    void OnCXXMethodDecl(clang::CXXMethodDecl const * const F, ScopeAnalysis & Analysis) override {
+        OnFunctionDecl(F, Analysis);
+    }
+
+    void Dump(clang::DiagnosticsEngine &) const override
+    { }
+
+private:
+    std::vector<FunctionFacts> & Results;
 };
 
 
-ModuleVisitor::Ptr ModuleVisitor::CreateVisitor(Target const State) {
+// Fills the verdicts of the library interface from the findings.
+class ResultsFindingWriter
+    : public FindingWriter {
+public:
+    explicit ResultsFindingWriter(AnalysisResults & Out)
+        : FindingWriter()
+        , Results(Out)
+    { }
+
+    void Write(FindingKind const Kind, clang::DeclaratorDecl const * const D, Impact const &) override {
+        switch (Kind) {
+        case ConstVariableFinding :
+            Results.ConstVariables.push_back(D);
+            break;
+        case ConstFunctionFinding :
+            Results.ConstMethods.push_back(clang::cast<clang::CXXMethodDecl const>(D));
+            break;
+        case StaticFunctionFinding :
+            Results.StaticMethods.push_back(clang::cast<clang::CXXMethodDecl const>(D));
+            break;
+        // only the thorough level reports those.
+        case ByValueParameterFinding :
+            Results.ByValueParameters.push_back(D);
+            break;
+        case FindingKindCount :
+            break;
+        }
+    }
+
+private:
+    AnalysisResults & Results;
+};
+
+
+// The common part of the library entry points: the traversal is given by
+// the caller, the findings are sorted before those are collected.
+template <typename Traverse>
+AnalysisResults RunAnalysis(bool const WithFacts, AnalysisLevel const Level, Traverse && Run) {
+    AnalysisResults Results;
+    ResultsFindingWriter Collector(Results);
+    SortedFindingWriter Sorted(Collector);
+
+    ModuleVisitor V(Level);
+    // the facts go first: the complete changes are computed once, the
+    // analysis does not limit (and walk again) the body then.
+    if (WithFacts) {
+        V.AddPass(AnalysisPass::Ptr( new CollectFunctionFacts(Results.Facts) ));
+    }
+    AnalyseVariableUsage * const Analysis = new AnalyseVariableUsage(Sorted, Level, false, nullptr);
+    V.AddPass(AnalysisPass::Ptr(Analysis));
+    Run(V);
+    Analysis->Report();
+    Sorted.Flush();
+    return Results;
+}
+
+
+AnalysisPass::Ptr AnalysisPass::CreatePass(Target const State, Options const & Config,
+                                           Profile const * const Counts,
+                                           clang::DiagnosticsEngine & DE, FindingWriter & Writer) {
+    // the loop depths are measured only for the ranking, the structured
+    // output does not pay for the usages of every function.
+    bool const MeasureImpact = Config.ImpactOrder || (0 != Config.MinImpact);
     switch (State) {
     case FuncionDeclaration :
-        return ModuleVisitor::Ptr( new DebugFunctionDeclarations() );
+        return AnalysisPass::Ptr( new DebugFunctionDeclarations() );
     case VariableDeclaration :
-        return ModuleVisitor::Ptr( new DebugVariableDeclarations() );
+        return AnalysisPass::Ptr( new DebugVariableDeclarations() );
     case VariableChanges:
-        return ModuleVisitor::Ptr( new DebugVariableChanges() );
+        return AnalysisPass::Ptr( new DebugVariableChanges(DE) );
     case VariableUsages :
-        return ModuleVisitor::Ptr( new DebugVariableUsages() );
+        return AnalysisPass::Ptr( new DebugVariableUsages(DE) );
     case PseudoConstness :
-        return ModuleVisitor::Ptr( new AnalyseVariableUsage() );
+        return AnalysisPass::Ptr( new AnalyseVariableUsage(Writer, Config.Level, MeasureImpact, Counts) );
     }
 }
 
 } // namespace anonymous
 
 
-ModuleAnalysis::ModuleAnalysis(clang::CompilerInstance const & Compiler, Target const T)
+ModuleAnalysis::ModuleAnalysis(clang::CompilerInstance const & Compiler, Options const & O)
     : clang::ASTConsumer()
     , Reporter(Compiler.getDiagnostics())
-    , State(T)
+    , Config(O)
+    , TimeReport(Compiler.getFrontendOpts().ShowTimers)
+    , FootprintReport(Compiler.getFrontendOpts().ShowStats)
+{ }
+
+ModuleAnalysis::ModuleAnalysis(clang::DiagnosticsEngine & DE, Options const & O)
+    : clang::ASTConsumer()
+    , Reporter(DE)
+    , Config(O)
+    , TimeReport(false)
+    , FootprintReport(false)
 { }
 
+bool ModuleAnalysis::shouldSkipFunctionBody(clang::Decl * const D) {
+    if (auto const F = D->getAsFunction()) {
+        if (F->isDependentContext()) {
+            return false;
+        }
+    }
+    return ! IsFromMainModule(D);
+}
+
 void ModuleAnalysis::HandleTranslationUnit(clang::ASTContext & Ctx) {
-    ModuleVisitor::Ptr const V = ModuleVisitor::CreateVisitor(State);
-    V->TraverseDecl(Ctx.getTranslationUnitDecl());
-    V->Dump(Reporter);
+    // The measured costs are not deterministic, those are never cached.
+    // (The statistics are not diagnostics, a cache hit does not print.)
+    if (Config.CacheDirectory.empty() || Config.TopCosts) {
+        Analyse(Ctx);
+        return;
+    }
+    // The preprocessor is done by now, this is the earliest point where
+    // the cache key can be computed.
+    clang::SourceManager & SM = Ctx.getSourceManager();
+    ResultCache const Cache(Config.CacheDirectory, SM, Config);
+    std::string const Output = Config.OutputPath.empty()
+        ? std::string()
+        : StructuredFindingWriter::GetPath(Config.OutputPath, Config.Format, SM);
+    if (Cache.Replay(Reporter, SM, Output))
+        return;
+
+    CachedDiagnostics Records;
+    {
+        DiagnosticRecorder const Recorder(Reporter, Records);
+        Analyse(Ctx);
+    }
+    if (! Reporter.hasErrorOccurred()) {
+        Cache.Store(Records, Output);
+    }
+}
+
+void ModuleAnalysis::Analyse(clang::ASTContext & Ctx) {
+    Statistics Stats(TimeReport, FootprintReport, Config.TopCosts);
+
+    FindingWriters Writers;
+    std::unique_ptr<TextFindingWriter> Text;
+    if (Config.TextOutput) {
+        Text.reset(new TextFindingWriter(Reporter));
+        Writers.Add(*Text);
+    }
+    std::unique_ptr<StructuredFindingWriter> Structured;
+    if (! Config.OutputPath.empty()) {
+        std::string Error;
+        Structured = StructuredFindingWriter::Create(Config.OutputPath, Config.Format,
+                                                     Ctx.getSourceManager(), Error);
+        if (Structured) {
+            Writers.Add(*Structured);
+        } else {
+            ReportOutputFailure(Reporter, Error);
+        }
+    }
+    std::unique_ptr<Baseline> Accepted;
+    std::unique_ptr<BaselineFindingWriter> Filter;
+    if (! Config.BaselinePath.empty()) {
+        std::string Error;
+        Accepted = Baseline::Load(Config.BaselinePath, Error);
+        if (Accepted) {
+            Filter.reset(new BaselineFindingWriter(*Accepted, Writers));
+        } else {
+            ReportBaselineFailure(Reporter, Error);
+        }
+    }
+    std::unique_ptr<Profile> Counts;
+    if (! Config.ProfilePath.empty()) {
+        std::string Error;
+        Counts = Profile::Load(Config.ProfilePath, Error);
+        if (! Counts) {
+            ReportProfileFailure(Reporter, Error);
+        }
+    }
+    {
+        Statistics::Activate const Active(Stats);
+
+        SortedFindingWriter Sorted(Filter ? static_cast<FindingWriter &>(*Filter) : Writers,
+                                   Config.ImpactOrder, Config.MinImpact, Config.MinEntryCount);
+        ModuleVisitor V(Config, Counts.get(), Reporter, Sorted);
+        {
+            Statistics::PhaseTimer const Timer(TraversalPhase);
+            V.TraverseDecl(Ctx.getTranslationUnitDecl());
+        }
+        {
+            Statistics::PhaseTimer const Timer(ReportingPhase);
+            V.Dump(Reporter);
+            Sorted.Flush();
+        }
+        Verdicts Actual;
+        if (Config.Oracle && V.GetVerdicts(Actual)) {
+            Verdicts const Expected = ReferenceVerdicts(Ctx);
+            CompareVerdicts(Reporter, Expected.ConstVariables, Actual.ConstVariables, "variable", "const");
+            CompareVerdicts(Reporter, Expected.ConstMethods, Actual.ConstMethods, "function", "const");
+            CompareVerdicts(Reporter, Expected.StaticMethods, Actual.StaticMethods, "function", "static");
+        }
+    }
+    if (Structured) {
+        std::string Error;
+        if (! Structured->Commit(Error)) {
+            ReportOutputFailure(Reporter, Error);
+        }
+    }
+    if (Config.PrintStats) {
+        Stats.Print(llvm::errs());
+    }
+    if (FootprintReport) {
+        Stats.PrintFootprint(llvm::errs());
+    }
+    if (Config.TopCosts) {
+        ReportCosts(Reporter, "function '%0' took %1 ms to analyse, visited %2 nodes",
+            Stats.GetCosts(FunctionCost));
+        ReportCosts(Reporter, "record '%0' took %1 ms to summarise, walked %2 declarations",
+            Stats.GetCosts(RecordSummaryCost));
+    }
+    for (auto && Budget : Config.Budgets) {
+        std::uint64_t const Value = Stats.Get(Budget.first);
+        if (Value > Budget.second) {
+            ReportBudgetExceeded(Reporter, Statistics::GetName(Budget.first), Value, Budget.second);
+        }
+    }
+}
+
+
+AnalysisResults AnalyseTranslationUnit(clang::ASTContext & Ctx, bool const WithFacts,
+                                       AnalysisLevel const Level) {
+    return RunAnalysis(WithFacts, Level, [&Ctx](ModuleVisitor & V) {
+        V.TraverseDecl(Ctx.getTranslationUnitDecl());
+    });
+}
+
+AnalysisResults AnalyseFunctions(std::vector<clang::FunctionDecl const *> const & Functions,
+                                 bool const WithFacts, AnalysisLevel const Level) {
+    return RunAnalysis(WithFacts, Level, [&Functions](ModuleVisitor & V) {
+        for (auto && F : Functions) {
+            V.VisitFunctionDecl(F);
+        }
+    });
 }
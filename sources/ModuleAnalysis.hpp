@@ -19,29 +19,35 @@
 
 #pragma once
 
+#include "Options.hpp"
+
 #include <clang/AST/ASTConsumer.h>
 #include <clang/Frontend/CompilerInstance.h>
 
-enum Target
-    { FuncionDeclaration
-    , VariableDeclaration
-    , VariableChanges
-    , VariableUsages
-    , PseudoConstness
-    };
-
 // It runs the pseudo const analysis on the given translation unit.
 class ModuleAnalysis : public clang::ASTConsumer {
 public:
-    ModuleAnalysis(clang::CompilerInstance const &, Target);
+    ModuleAnalysis(clang::CompilerInstance const &, Options const &);
+    ModuleAnalysis(clang::DiagnosticsEngine &, Options const &);
 
     void HandleTranslationUnit(clang::ASTContext &) override;
 
+    // Function bodies outside of the main file are not reported, there is
+    // no need to parse those. (The frontend asks this only when function
+    // body skipping was enabled.) Templates are kept, their instantiations
+    // might change the variables of the main file.
+    bool shouldSkipFunctionBody(clang::Decl *) override;
+
 
     ModuleAnalysis(ModuleAnalysis const &) = delete;
     ModuleAnalysis & operator=(ModuleAnalysis const &) = delete;
 
+private:
+    void Analyse(clang::ASTContext &);
+
 private:
     clang::DiagnosticsEngine & Reporter;
-    Target const State;
+    Options const Config;
+    bool const TimeReport;
+    bool const FootprintReport;
 };
@@ -0,0 +1,278 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Options.hpp"
+
+#include <string>
+#include <tuple>
+
+#include <llvm/ADT/SmallVector.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/ADT/StringSwitch.h>
+
+
+namespace {
+
+// The targets are given as a comma separated list.
+bool ParseTargets(llvm::StringRef const Value, Targets & Out) {
+    llvm::SmallVector<llvm::StringRef, 5> Names;
+    Value.split(Names, ",", -1, false);
+    if (Names.empty())
+        return false;
+
+    Targets Result;
+    for (auto && Name : Names) {
+        int const Current = llvm::StringSwitch<int>(Name.trim())
+            .Case("FuncionDeclaration", FuncionDeclaration)
+            .Case("VariableDeclaration", VariableDeclaration)
+            .Case("VariableChanges", VariableChanges)
+            .Case("VariableUsages", VariableUsages)
+            .Case("PseudoConstness", PseudoConstness)
+            .Default(-1);
+        if (Current < 0)
+            return false;
+        Result.insert(static_cast<Target>(Current));
+    }
+    Out = Result;
+    return true;
+}
+
+bool ParseFormat(llvm::StringRef const Value, OutputFormat & Out) {
+    int const Result = llvm::StringSwitch<int>(Value)
+        .Case("jsonl", JsonLinesOutput)
+        .Case("sarif", SarifOutput)
+        .Default(-1);
+    if (Result < 0)
+        return false;
+
+    Out = static_cast<OutputFormat>(Result);
+    return true;
+}
+
+bool ParseLevel(llvm::StringRef const Value, AnalysisLevel & Out) {
+    int const Result = llvm::StringSwitch<int>(Value)
+        .Case("fast", FastLevel)
+        .Case("default", DefaultLevel)
+        .Case("thorough", ThoroughLevel)
+        .Default(-1);
+    if (Result < 0)
+        return false;
+
+    Out = static_cast<AnalysisLevel>(Result);
+    return true;
+}
+
+// The budget is given as '<counter>:<limit>'.
+bool ParseBudget(llvm::StringRef const Value, std::map<Counter, std::uint64_t> & Out) {
+    llvm::StringRef Name, Limit;
+    std::tie(Name, Limit) = Value.split(':');
+
+    Counter Which;
+    std::uint64_t Number = 0;
+    if ((! Statistics::FindCounter(Name, Which)) || Limit.getAsInteger(10, Number))
+        return false;
+
+    Out[Which] = Number;
+    return true;
+}
+
+} // namespace anonymous
+
+
+Options::Options()
+    : Debug({ PseudoConstness })
+    , Level(DefaultLevel)
+    , CacheDirectory()
+    , PrintStats(false)
+    , Budgets()
+    , Oracle(false)
+    , TopCosts(0)
+    , OutputPath()
+    , Format(JsonLinesOutput)
+    , TextOutput(true)
+    , BaselinePath()
+    , ImpactOrder(false)
+    , MinImpact(0)
+    , ProfilePath()
+    , MinEntryCount(0)
+{ }
+
+bool ParseOptions(std::vector<std::string> const & Args, Options & Out, std::string & Error) {
+    for (auto It = Args.begin(), End = Args.end(); It != End; ++It) {
+        // accept '-name=value', '--name=value' and '-name value' forms.
+        llvm::StringRef const Arg = llvm::StringRef(*It).ltrim("-");
+        llvm::StringRef Name, Value;
+        std::tie(Name, Value) = Arg.split('=');
+        bool const HasValue = (llvm::StringRef::npos != Arg.find('='));
+
+        auto const TakeValue = [&]() -> bool {
+            if (HasValue)
+                return true;
+            if (End == (It + 1)) {
+                Error = "missing value for argument '" + *It + "'";
+                return false;
+            }
+            Value = *(++It);
+            return true;
+        };
+        // flags are not taking values, '-oracle=false' is not a way to
+        // turn it off.
+        auto const TakeNoValue = [&]() -> bool {
+            if (! HasValue)
+                return true;
+            Error = "argument '" + *It + "' does not take a value";
+            return false;
+        };
+
+        if (Name == "debug-constantine") {
+            if (! TakeValue())
+                return false;
+            if (! ParseTargets(Value, Out.Debug)) {
+                Error = "unknown value '" + Value.str() + "' for argument 'debug-constantine'";
+                return false;
+            }
+        } else if (Name == "analysis-level") {
+            if (! TakeValue())
+                return false;
+            if (! ParseLevel(Value, Out.Level)) {
+                Error = "unknown value '" + Value.str() + "' for argument 'analysis-level'";
+                return false;
+            }
+        } else if (Name == "cache-dir") {
+            if (! TakeValue())
+                return false;
+            Out.CacheDirectory = Value;
+        } else if (Name == "print-stats") {
+            if (! TakeNoValue())
+                return false;
+            Out.PrintStats = true;
+        } else if (Name == "oracle") {
+            if (! TakeNoValue())
+                return false;
+            Out.Oracle = true;
+        } else if (Name == "top-costs") {
+            if (! TakeValue())
+                return false;
+            if (Value.getAsInteger(10, Out.TopCosts)) {
+                Error = "invalid value '" + Value.str() + "' for argument 'top-costs'";
+                return false;
+            }
+        } else if (Name == "output") {
+            if (! TakeValue())
+                return false;
+            Out.OutputPath = Value;
+        } else if (Name == "output-format") {
+            if (! TakeValue())
+                return false;
+            if (! ParseFormat(Value, Out.Format)) {
+                Error = "unknown value '" + Value.str() + "' for argument 'output-format'";
+                return false;
+            }
+        } else if (Name == "baseline") {
+            if (! TakeValue())
+                return false;
+            Out.BaselinePath = Value;
+        } else if (Name == "impact-order") {
+            if (! TakeNoValue())
+                return false;
+            Out.ImpactOrder = true;
+        } else if (Name == "min-impact") {
+            if (! TakeValue())
+                return false;
+            if (Value.getAsInteger(10, Out.MinImpact)) {
+                Error = "invalid value '" + Value.str() + "' for argument 'min-impact'";
+                return false;
+            }
+        } else if (Name == "profile") {
+            if (! TakeValue())
+                return false;
+            Out.ProfilePath = Value;
+        } else if (Name == "min-entry-count") {
+            if (! TakeValue())
+                return false;
+            if (Value.getAsInteger(10, Out.MinEntryCount)) {
+                Error = "invalid value '" + Value.str() + "' for argument 'min-entry-count'";
+                return false;
+            }
+        } else if (Name == "no-text-output") {
+            if (! TakeNoValue())
+                return false;
+            Out.TextOutput = false;
+        } else if (Name == "work-budget") {
+            if (! TakeValue())
+                return false;
+            if (! ParseBudget(Value, Out.Budgets)) {
+                Error = "invalid value '" + Value.str() + "' for argument 'work-budget'";
+                return false;
+            }
+        } else {
+            Error = "unknown argument '" + *It + "'";
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string OptionsFingerprint(Options const & O) {
+    // the cache directory does not change the findings, left out.
+    std::string Result = "debug-constantine=";
+    for (auto && Current : O.Debug) {
+        Result += std::to_string(Current) + ",";
+    }
+    if (DefaultLevel != O.Level) {
+        Result += " analysis-level=" + std::to_string(O.Level);
+    }
+    for (auto && Budget : O.Budgets) {
+        Result += " work-budget=";
+        Result += Statistics::GetName(Budget.first);
+        Result += ":" + std::to_string(Budget.second);
+    }
+    if (O.Oracle) {
+        Result += " oracle";
+    }
+    if (! O.TextOutput) {
+        Result += " no-text-output";
+    }
+    if (O.TopCosts) {
+        Result += " top-costs=" + std::to_string(O.TopCosts);
+    }
+    // the output is cached with the findings, its path does not matter.
+    if (! O.OutputPath.empty()) {
+        Result += " output-format=" + std::to_string(O.Format);
+    }
+    // the baseline file itself is hashed by the result cache.
+    if (! O.BaselinePath.empty()) {
+        Result += " baseline=" + O.BaselinePath;
+    }
+    if (O.ImpactOrder) {
+        Result += " impact-order";
+    }
+    if (O.MinImpact) {
+        Result += " min-impact=" + std::to_string(O.MinImpact);
+    }
+    // the profile itself is hashed by the result cache.
+    if (! O.ProfilePath.empty()) {
+        Result += " profile=" + O.ProfilePath;
+    }
+    if (O.MinEntryCount) {
+        Result += " min-entry-count=" + std::to_string(O.MinEntryCount);
+    }
+    return Result;
+}
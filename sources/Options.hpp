@@ -0,0 +1,100 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "Statistics.hpp"
+
+#include <cstdint>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+enum Target
+    { FuncionDeclaration
+    , VariableDeclaration
+    , VariableChanges
+    , VariableUsages
+    , PseudoConstness
+    };
+
+// The formats of the structured output.
+enum OutputFormat
+    { JsonLinesOutput
+    , SarifOutput
+    };
+
+// The precision of the pseudo constness analysis.
+enum AnalysisLevel
+    { FastLevel         // locals and parameters only, without alias tracking
+    , DefaultLevel
+    , ThoroughLevel     // changes of any variable in any function are tracked
+    };
+
+// The analyses to run, each one is a pass of the same traversal.
+typedef std::set<Target> Targets;
+
+// The plugin arguments. Every plugin instance parses its own copy, there
+// is no global state shared between compiler instances.
+struct Options {
+    Options();
+
+    Targets Debug;
+    AnalysisLevel Level;
+    // Where to keep the whole translation unit results. (Empty means
+    // no caching.)
+    std::string CacheDirectory;
+    // Print the work counters at the end of the translation unit.
+    bool PrintStats;
+    // Upper limits of the work counters. Exceeding one is a warning.
+    std::map<Counter, std::uint64_t> Budgets;
+    // Run the reference engine too, and report the differences.
+    bool Oracle;
+    // Report this many of the most expensive functions and records.
+    unsigned TopCosts;
+    // Where to write the findings in structured format. (Empty means no
+    // structured output, a directory means a file per translation unit.)
+    std::string OutputPath;
+    OutputFormat Format;
+    // Report the findings as compiler warnings.
+    bool TextOutput;
+    // The file of the accepted findings, which are not reported. (Empty
+    // means every finding is reported.)
+    std::string BaselinePath;
+    // Report the findings by descending impact score, not in source order.
+    bool ImpactOrder;
+    // Findings with lower impact score are not reported. (Zero means every
+    // finding is reported.)
+    std::uint64_t MinImpact;
+    // The indexed instrumentation profile, to annotate the findings with
+    // the entry count of their function. (Empty means no profile.)
+    std::string ProfilePath;
+    // Findings in functions entered less times (or not in the profile)
+    // are not reported. (Zero means every finding is reported.)
+    std::uint64_t MinEntryCount;
+};
+
+// Parse the plugin arguments. Returns false and fills the error message
+// when an argument was not recognised.
+bool ParseOptions(std::vector<std::string> const &, Options &, std::string & Error);
+
+// Canonical text of the options which can change the findings.
+std::string OptionsFingerprint(Options const &);
@@ -22,8 +22,6 @@
 #include <iterator>
 #include <memory>
 
-#include "llvm/Support/CommandLine.h"
-
 #include <clang/Frontend/FrontendPluginRegistry.h>
 #include <clang/Frontend/CompilerInstance.h>
 #include <clang/AST/ASTConsumer.h>
@@ -49,7 +47,7 @@ class Plugin
 public:
     Plugin()
         : clang::PluginASTAction()
-        , Debug(PseudoConstness)
+        , Config()
     { }
 
     Plugin(Plugin const &) = delete;
@@ -62,45 +60,46 @@ private:
         return Opts.CPlusPlus;
     }
 
+    // Decide wheater the compiler was invoked only to analyse the code.
+    // (Without the code generation, the bodies are needed only for us.)
+    static bool IsAnalysisOnly(clang::CompilerInstance const & Compiler) {
+        clang::frontend::ActionKind const Action =
+            Compiler.getFrontendOpts().ProgramAction;
+        return (clang::frontend::ParseSyntaxOnly == Action)
+            || (clang::frontend::PluginAction == Action);
+    }
+
     // ..:: Entry point for plugins ::..
     std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(clang::CompilerInstance & C, llvm::StringRef) override {
-        return IsCPlusPlus(C)
-            ? std::unique_ptr<clang::ASTConsumer>(new ModuleAnalysis(C, Debug))
-            : std::unique_ptr<clang::ASTConsumer>(new NullConsumer());
+        if (! IsCPlusPlus(C)) {
+            return std::unique_ptr<clang::ASTConsumer>(new NullConsumer());
+        }
+        // The analysis reports only the main file, bodies from the
+        // headers are not parsed. (Debug targets dump everything, and the
+        // thorough level needs the changes from every function.)
+        if (IsAnalysisOnly(C) && (Targets({ PseudoConstness }) == Config.Debug)
+                && (ThoroughLevel != Config.Level)) {
+            C.getFrontendOpts().SkipFunctionBodies = true;
+        }
+        return std::unique_ptr<clang::ASTConsumer>(new ModuleAnalysis(C, Config));
     }
 
     // ..:: Entry point for plugins ::..
-    bool ParseArgs(clang::CompilerInstance const &,
+    bool ParseArgs(clang::CompilerInstance const & Compiler,
                    std::vector<std::string> const & Args) override {
-        std::vector<char const *> ArgPtrs;
-        {
-            // make llvm::cl::ParseCommandLineOptions happy
-            ArgPtrs.push_back(plugin_name);
-            for (auto && Arg : Args) {
-                ArgPtrs.push_back(Arg.c_str());
-            }
-        }
-        {
-            static llvm::cl::opt<Target> const
-                DebugParser("debug-constantine",
-                    llvm::cl::desc("Set the debugging level for Constantine plugin:"),
-                    llvm::cl::init(PseudoConstness),
-                    llvm::cl::values(
-                        clEnumVal(FuncionDeclaration, "Enable function detection"),
-                        clEnumVal(VariableDeclaration, "Enable variables detection"),
-                        clEnumVal(VariableChanges, "Enable variable change detection"),
-                        clEnumVal(VariableUsages, "Enable variable usage detection"),
-                        clEnumValEnd));
-
-            llvm::cl::ParseCommandLineOptions(ArgPtrs.size(), &ArgPtrs.front());
-
-            Debug = DebugParser;
+        std::string Error;
+        if (! ParseOptions(Args, Config, Error)) {
+            clang::DiagnosticsEngine & DE = Compiler.getDiagnostics();
+            unsigned const Id =
+                DE.getCustomDiagID(clang::DiagnosticsEngine::Error, "%0 plugin: %1");
+            DE.Report(Id) << plugin_name << Error;
+            return false;
         }
         return true;
     }
 
 private:
-    Target Debug;
+    Options Config;
 };
 
 } // namespace anonymous
@@ -0,0 +1,156 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Profile.hpp"
+
+#include <algorithm>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include <clang/AST/DeclTemplate.h>
+#include <clang/Basic/ABI.h>
+#include <llvm/ProfileData/InstrProfReader.h>
+#include <llvm/Support/ErrorOr.h>
+#include <llvm/Support/MathExtras.h>
+#include <llvm/Support/raw_ostream.h>
+
+
+std::unique_ptr<Profile> Profile::Load(std::string const & Path, std::string & Error) {
+    llvm::ErrorOr<std::unique_ptr<llvm::IndexedInstrProfReader>> Reader =
+        llvm::IndexedInstrProfReader::create(Path);
+    if (! Reader) {
+        Error = "cannot read '" + Path + "': " + Reader.getError().message();
+        return std::unique_ptr<Profile>();
+    }
+    return std::unique_ptr<Profile>(new Profile(std::move(Reader.get())));
+}
+
+Profile::Profile(std::unique_ptr<llvm::IndexedInstrProfReader> Input)
+    : Reader(std::move(Input))
+    , Counts()
+    , Context(nullptr)
+    , Mangler()
+{ }
+
+Profile::~Profile()
+{ }
+
+llvm::StringMap<std::uint64_t> const & Profile::GetCounts() const {
+    if (! Reader)
+        return Counts;
+
+    for (auto && Record : *Reader) {
+        // the first counter of the clang instrumentation is the entry.
+        if (Record.Counts.empty())
+            continue;
+        llvm::StringRef Name = Record.Name;
+        std::size_t const Separator = Name.rfind(':');
+        if (llvm::StringRef::npos != Separator) {
+            Name = Name.substr(Separator + 1);
+        }
+        std::uint64_t & Count = Counts[Name];
+        Count = std::max(Count, Record.Counts.front());
+    }
+    // a broken profile has no counts.
+    if (Reader->hasError()) {
+        Counts.clear();
+    }
+    Reader.reset();
+    return Counts;
+}
+
+namespace {
+
+// The instantiations of a function template, or of a method of a class
+// template, which were made in this translation unit. (Member templates of
+// class templates are not followed.)
+void CollectInstances(clang::FunctionDecl const * const F,
+                      std::vector<clang::FunctionDecl const *> & Out) {
+    if (auto const T = F->getDescribedFunctionTemplate()) {
+        for (auto && Instance : T->specializations()) {
+            Out.push_back(Instance);
+        }
+        return;
+    }
+    auto const M = clang::dyn_cast<clang::CXXMethodDecl const>(F);
+    if (! M)
+        return;
+    auto const T = M->getParent()->getDescribedClassTemplate();
+    if (! T)
+        return;
+    for (auto && Record : T->specializations()) {
+        for (auto && Method : Record->methods()) {
+            auto const Pattern = Method->getInstantiatedFromMemberFunction();
+            if (Pattern && (Pattern->getCanonicalDecl() == M->getCanonicalDecl())) {
+                Out.push_back(Method);
+            }
+        }
+    }
+}
+
+} // namespace anonymous
+
+std::string Profile::GetProfileName(clang::FunctionDecl const * const F) const {
+    clang::ASTContext & Ctx = F->getASTContext();
+    if (&Ctx != Context) {
+        Mangler.reset(Ctx.createMangleContext());
+        Context = &Ctx;
+    }
+    if (! Mangler->shouldMangleDeclName(F))
+        return F->getName();
+
+    std::string Result;
+    llvm::raw_string_ostream OS(Result);
+    // only the base variant of the constructors and destructors are
+    // instrumented, the others are delegating to it.
+    if (auto const C = clang::dyn_cast<clang::CXXConstructorDecl const>(F)) {
+        Mangler->mangleCXXCtor(C, clang::Ctor_Base, OS);
+    } else if (auto const D = clang::dyn_cast<clang::CXXDestructorDecl const>(F)) {
+        Mangler->mangleCXXDtor(D, clang::Dtor_Base, OS);
+    } else {
+        Mangler->mangleName(F, OS);
+    }
+    return OS.str();
+}
+
+bool Profile::GetEntryCount(clang::FunctionDecl const * const F, std::uint64_t & Count) const {
+    llvm::StringMap<std::uint64_t> const & Entries = GetCounts();
+    if (Entries.empty())
+        return false;
+
+    // templates are not emitted, only their instantiations.
+    std::vector<clang::FunctionDecl const *> Functions;
+    if (F->isDependentContext()) {
+        CollectInstances(F, Functions);
+    } else {
+        Functions.push_back(F);
+    }
+    bool Found = false;
+    Count = 0;
+    for (auto && Function : Functions) {
+        auto const It = Entries.find(GetProfileName(Function));
+        if (Entries.end() != It) {
+            Count = llvm::SaturatingAdd(Count, It->second);
+            Found = true;
+        }
+    }
+    return Found;
+}
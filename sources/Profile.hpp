@@ -0,0 +1,74 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include <clang/AST/AST.h>
+#include <clang/AST/Mangle.h>
+#include <llvm/ADT/StringMap.h>
+
+namespace llvm {
+    class IndexedInstrProfReader;
+}
+
+
+// The function entry counts of an indexed instrumentation profile. (The
+// '.profdata' file made by 'llvm-profdata merge'.)
+//
+// The functions are looked up by their mangled name. The structural hash
+// of the profile records is not checked, the plugin can not compute it:
+// a stale profile gives the counts of the old function. Functions with
+// internal linkage are recorded with the file name prefix, which is not
+// matched, same named static functions of different files are merged.
+//
+// The records are keyed by name and hash, a lookup by name only is not
+// possible. The names are read into a map at the first lookup, which is
+// proportional to the profile size. (Translation units without findings
+// do not pay for it, loading reads only the header.)
+class Profile {
+public:
+    static std::unique_ptr<Profile> Load(std::string const & Path, std::string & Error);
+    ~Profile();
+
+    // Returns false when the function is not in the profile. The templates
+    // have the sum of their instantiations (made in this translation unit).
+    bool GetEntryCount(clang::FunctionDecl const *, std::uint64_t & Count) const;
+
+    Profile(Profile const &) = delete;
+    Profile & operator=(Profile const &) = delete;
+
+private:
+    explicit Profile(std::unique_ptr<llvm::IndexedInstrProfReader>);
+
+    std::string GetProfileName(clang::FunctionDecl const *) const;
+    llvm::StringMap<std::uint64_t> const & GetCounts() const;
+
+private:
+    // The reader is released once the records were read.
+    mutable std::unique_ptr<llvm::IndexedInstrProfReader> Reader;
+    mutable llvm::StringMap<std::uint64_t> Counts;
+    // The mangler belongs to the AST context of the last query.
+    mutable clang::ASTContext const * Context;
+    mutable std::unique_ptr<clang::MangleContext> Mangler;
+};
@@ -0,0 +1,635 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ReferenceAnalysis.hpp"
+#include "IsFromMainModule.hpp"
+
+#include <algorithm>
+#include <iterator>
+#include <list>
+#include <map>
+#include <tuple>
+
+#include <clang/AST/RecursiveASTVisitor.h>
+
+
+namespace {
+// The names are in a separate namespace, to not clash with the optimised
+// engine's functions declared in DeclarationCollector.hpp.
+namespace reference {
+
+typedef std::tuple<clang::QualType, clang::SourceRange> UsageRef;
+typedef std::list<UsageRef> UsageRefs;
+typedef std::map<clang::DeclaratorDecl const *, UsageRefs> UsageRefsMap;
+
+clang::QualType const NoType = clang::QualType();
+clang::SourceRange const NoRange = clang::SourceRange();
+
+
+// Declaration collector functions.
+
+std::set<clang::CXXRecordDecl const *> AllBase(clang::CXXRecordDecl const * Record) {
+    std::set<clang::CXXRecordDecl const *> Result;
+
+    llvm::SmallVector<clang::CXXRecordDecl const *, 8> Queue;
+    Queue.push_back(Record);
+
+    while (! Queue.empty()) {
+        auto const Current = Queue.pop_back_val();
+        for (const auto & BaseIt : Current->bases()) {
+            if (auto const * Record = BaseIt.getType()->getAs<clang::RecordType>()) {
+                if (auto const * Base = clang::cast_or_null<clang::CXXRecordDecl>(Record->getDecl()->getDefinition())) {
+                    Queue.push_back(Base);
+                }
+            }
+        }
+        Result.insert(Current);
+    }
+    return Result;
+}
+
+// Strip away parentheses and casts we don't care about.
+clang::Expr const * StripExpr(clang::Expr const * E) {
+    while (E) {
+        if (auto const * const Paren = clang::dyn_cast<clang::ParenExpr const>(E)) {
+            E = Paren->getSubExpr();
+            continue;
+        }
+        if (auto const CE = clang::dyn_cast<clang::CastExpr const>(E)) {
+            E = CE->getSubExpr();
+            continue;
+        }
+        if (auto const UnOp = clang::dyn_cast<clang::UnaryOperator const>(E)) {
+            E = UnOp->getSubExpr();
+            continue;
+        }
+        if (auto const M = clang::dyn_cast<clang::MaterializeTemporaryExpr const>(E)) {
+            E = M->GetTemporaryExpr();
+            continue;
+        }
+        if (auto const ASE = clang::dyn_cast<clang::ArraySubscriptExpr const>(E)) {
+            E = ASE->getBase();
+            continue;
+        }
+        break;
+    }
+    return E;
+}
+
+std::set<clang::Expr const *> CollectRefereeExpr(clang::Expr const * const E) {
+    std::set<clang::Expr const *> Result;
+
+    std::set<clang::Expr const *> Works;
+    Works.insert(E);
+
+    while (! Works.empty()) {
+        auto const Current = *(Works.begin());
+        Works.erase(Works.begin());
+
+        if (decltype(Current) const Stripped = StripExpr(Current)) {
+            if (clang::dyn_cast<clang::DeclRefExpr const>(Stripped)) {
+                Result.insert(Stripped);
+            } else if (auto ME = clang::dyn_cast<clang::MemberExpr const>(Stripped)) {
+                // Dig into member variable access to register the outer variable
+                while (ME) {
+                    if (decltype(ME) const Candidate = clang::dyn_cast<clang::MemberExpr const>(ME->getBase())) {
+                        ME = Candidate;
+                        continue;
+                    }
+                    break;
+                }
+                Result.insert(ME);
+            } else if (auto const ACO = clang::dyn_cast<clang::AbstractConditionalOperator const>(Stripped)) {
+                Works.insert(ACO->getTrueExpr());
+                Works.insert(ACO->getFalseExpr());
+            }
+        }
+    }
+    return Result;
+}
+
+clang::DeclaratorDecl const * GetDeclarationFromExpr(clang::Expr const * const E) {
+    clang::ValueDecl const * RefVal = nullptr;
+
+    if (auto const DRE = clang::dyn_cast<clang::DeclRefExpr const>(E)) {
+        RefVal = DRE->getDecl();
+    } else if (auto const ME = clang::dyn_cast<clang::MemberExpr const>(E)) {
+        RefVal = ME->getMemberDecl();
+    }
+
+    return (RefVal) ? clang::dyn_cast<clang::DeclaratorDecl const>(RefVal) : nullptr;
+}
+
+Variables GetVariablesFromContext(clang::DeclContext const * const F, bool const WithArgs = true) {
+    Variables Result;
+    for (auto const & It : F->decls()) {
+        if (auto const D = clang::dyn_cast<clang::VarDecl const>(It)) {
+            if (WithArgs || (!clang::dyn_cast<clang::ParmVarDecl const>(D))) {
+                Result.insert(D);
+            }
+        }
+    }
+    return Result;
+}
+
+Variables GetVariablesFromRecord(clang::CXXRecordDecl const * const Record) {
+    Variables Result;
+    for (auto const & RecordIt : AllBase(Record)) {
+        for (const auto & FieldIt : RecordIt->fields()) {
+            Result.insert(FieldIt);
+        }
+    }
+    return Result;
+}
+
+Methods GetMethodsFromRecord(clang::CXXRecordDecl const * const Record) {
+    Methods Result;
+    for (auto const & RecordIt : AllBase(Record)) {
+        for (auto const & MethodIt : RecordIt->methods()) {
+            Result.insert(MethodIt->getCanonicalDecl());
+        }
+    }
+    return Result;
+}
+
+Variables GetReferedVariables(clang::DeclaratorDecl const * const D) {
+    Variables Result;
+
+    Variables Works;
+    Works.insert(D);
+
+    while (! Works.empty()) {
+        // get the current element
+        auto const Current = *(Works.begin());
+        Works.erase(Works.begin());
+        // current element goes into results
+        if (Current) {
+            Result.insert(Current);
+        } else {
+            continue;
+        }
+        // check is it reference or pointer type
+        {
+            auto const & T = Current->getType();
+            if (! ((*T).isReferenceType() || (*T).isPointerType())) {
+                continue;
+            }
+        }
+        // check is it refer to a variable
+        if (auto const Variable = clang::dyn_cast<clang::VarDecl const>(Current)) {
+            // get the initialization expression
+            for (auto && Expression: CollectRefereeExpr(Variable->getInit())) {
+                Works.insert(GetDeclarationFromExpr(Expression));
+            }
+        }
+    }
+    return Result;
+}
+
+Variables GetMemberVariablesAndReferences(clang::CXXRecordDecl const * const Rec, clang::DeclContext const * const F) {
+    Variables Members = GetVariablesFromRecord(Rec);
+    Variables const & Locals = GetVariablesFromContext(F);
+    for (auto const &Local : Locals) {
+        Variables const &Refs = GetReferedVariables(Local);
+        for (auto ReIt(Refs.begin()), ReEnd(Refs.end()); ReIt != ReEnd; ++ReIt) {
+            if (Members.count(*ReIt)) {
+                Members.insert(Refs.begin(), Refs.end());
+                break;
+            }
+        }
+    }
+    return Members;
+}
+
+
+// Scope analysis.
+
+class ThisFinder
+    : public clang::RecursiveASTVisitor<ThisFinder> {
+public:
+    static bool Check(clang::Stmt const * const Stmt) {
+        ThisFinder V;
+        V.TraverseStmt(const_cast<clang::Stmt*>(Stmt));
+        return V.Found;
+    }
+
+    bool VisitCXXThisExpr(clang::CXXThisExpr const *) {
+        Found = true;
+        return true;
+    }
+
+private:
+    ThisFinder()
+        : clang::RecursiveASTVisitor<ThisFinder>()
+        , Found(false)
+    { }
+
+    ThisFinder(ThisFinder const &) = delete;
+    ThisFinder & operator=(ThisFinder const &) = delete;
+
+private:
+    bool Found;
+};
+
+class UsageExtractor
+    : public clang::RecursiveASTVisitor<UsageExtractor> {
+public:
+    UsageExtractor(UsageRefsMap & Out, clang::QualType const & InType)
+        : clang::RecursiveASTVisitor<UsageExtractor>()
+        , Results(Out)
+        , State(InType, NoRange)
+    { }
+
+    UsageExtractor(UsageExtractor const &) = delete;
+    UsageExtractor & operator=(UsageExtractor const &) = delete;
+
+private:
+    void Capture(clang::Expr const * const E) {
+        // do nothing if it already has type info
+        if (std::get<0>(State) != NoType)
+            return;
+
+        State = std::make_tuple(E->getType(), E->getSourceRange());
+    }
+
+    void RegisterUsage(clang::ValueDecl const * const Decl,
+                       clang::SourceRange const & Location) {
+        std::get<1>(State) = Location;
+        if (auto const D = clang::dyn_cast<clang::DeclaratorDecl const>(Decl->getCanonicalDecl())) {
+            auto It = Results.find(D);
+            if (Results.end() == It) {
+                auto const R = Results.insert(UsageRefsMap::value_type(D, UsageRefs()));
+                It = R.first;
+            }
+            UsageRefs & Ls = It->second;
+            Ls.push_back(State);
+        }
+        // reset the state for the next call
+        State = std::make_tuple(NoType, NoRange);
+    }
+
+public:
+    bool VisitCastExpr(clang::CastExpr const * const E) {
+        Capture(E);
+        return true;
+    }
+
+    bool VisitUnaryOperator(clang::UnaryOperator const * const E) {
+        switch (E->getOpcode()) {
+        case clang::UO_AddrOf:
+        case clang::UO_Deref:
+            Capture(E);
+        default:
+            ;
+        }
+        return true;
+    }
+
+    bool VisitDeclRefExpr(clang::DeclRefExpr const * const E) {
+        Capture(E);
+        RegisterUsage(E->getDecl(), E->getSourceRange());
+        return true;
+    }
+
+    bool VisitMemberExpr(clang::MemberExpr const * const E) {
+        Capture(E);
+        RegisterUsage(E->getMemberDecl(), E->getSourceRange());
+        return true;
+    }
+
+private:
+    UsageRefsMap & Results;
+    UsageRef State;
+};
+
+void Register(UsageRefsMap & Results,
+              clang::Expr const * E,
+              clang::QualType const & Type = clang::QualType()) {
+    clang::Stmt const * const Stmt = E;
+
+    UsageExtractor Visitor(Results, Type);
+    Visitor.TraverseStmt(const_cast<clang::Stmt*>(Stmt));
+}
+
+class VariableChangeCollector
+    : public clang::RecursiveASTVisitor<VariableChangeCollector> {
+public:
+    VariableChangeCollector(UsageRefsMap & Out)
+        : clang::RecursiveASTVisitor<VariableChangeCollector>()
+        , Results(Out)
+    { }
+
+public:
+    bool VisitBinaryOperator(clang::BinaryOperator const * const Stmt) {
+        if (Stmt->isAssignmentOp()) {
+            Register(Results, Stmt->getLHS());
+        }
+        return true;
+    }
+
+    bool VisitUnaryOperator(clang::UnaryOperator const * const Stmt) {
+        if (Stmt->isIncrementDecrementOp()) {
+            Register(Results, Stmt->getSubExpr());
+        }
+        return true;
+    }
+
+    bool VisitCXXConstructExpr(clang::CXXConstructExpr const * const Stmt) {
+        auto const F = Stmt->getConstructor();
+        auto const Args = std::min(Stmt->getNumArgs(), F->getNumParams());
+        for (auto It = 0u; It < Args; ++It) {
+            auto const P = F->getParamDecl(It);
+            if (IsNonConstReferenced(P->getType())) {
+                Register(Results, Stmt->getArg(It), (*(P->getType())).getPointeeType());
+            }
+        }
+        return true;
+    }
+
+    bool VisitCallExpr(clang::CallExpr const * const Stmt) {
+        auto const Offset = HasThisAsFirstArgument(Stmt) ? 1 : 0;
+
+        if (auto const F = Stmt->getDirectCallee()) {
+            auto const Args = std::min(Stmt->getNumArgs(), F->getNumParams());
+            for (auto It = 0u; It < Args; ++It) {
+                auto const P = F->getParamDecl(It);
+                if (IsNonConstReferenced(P->getType())) {
+                    assert(It + Offset <= Stmt->getNumArgs());
+                    Register(Results, Stmt->getArg(It + Offset),
+                                 (*(P->getType())).getPointeeType());
+                }
+            }
+        }
+        return true;
+    }
+
+    bool VisitCXXMemberCallExpr(clang::CXXMemberCallExpr const * const Stmt) {
+        if (auto const MD = Stmt->getMethodDecl()) {
+            if ((! MD->isConst()) && (! MD->isStatic())) {
+                Register(Results, Stmt->getImplicitObjectArgument());
+            }
+        }
+        return true;
+    }
+
+    bool VisitCXXOperatorCallExpr(clang::CXXOperatorCallExpr const * const Stmt) {
+        if (auto const F = Stmt->getDirectCallee()) {
+            if (auto const MD = clang::dyn_cast<clang::CXXMethodDecl const>(F)) {
+                if ((! MD->isConst()) && (! MD->isStatic()) && (0 < Stmt->getNumArgs())) {
+                    Register(Results, Stmt->getArg(0));
+                }
+            }
+        }
+        return true;
+    }
+
+    bool VisitCXXNewExpr(clang::CXXNewExpr const * const Stmt) {
+        auto const Args = Stmt->getNumPlacementArgs();
+        for (auto It = 0u; It < Args; ++It) {
+            Register(Results, Stmt->getPlacementArg(It));
+        }
+        return true;
+    }
+
+private:
+    static bool IsNonConstReferenced(clang::QualType const & Decl) {
+        return
+            ((*Decl).isReferenceType() || (*Decl).isPointerType())
+            && (! (*Decl).getPointeeType().isConstQualified());
+    }
+
+    static bool HasThisAsFirstArgument(clang::CallExpr const * const Stmt) {
+        return
+            (clang::dyn_cast<clang::CXXOperatorCallExpr const>(Stmt)) &&
+            (Stmt->getDirectCallee()) &&
+            (clang::dyn_cast<clang::CXXMethodDecl const>(Stmt->getDirectCallee()));
+    }
+
+private:
+    UsageRefsMap & Results;
+};
+
+class VariableAccessCollector
+    : public clang::RecursiveASTVisitor<VariableAccessCollector> {
+public:
+    VariableAccessCollector(UsageRefsMap & Out)
+        : clang::RecursiveASTVisitor<VariableAccessCollector>()
+        , Results(Out)
+    { }
+
+public:
+    bool VisitDeclRefExpr(clang::DeclRefExpr const * const Stmt) {
+        Register(Results, Stmt);
+        return true;
+    }
+
+    bool VisitMemberExpr(clang::MemberExpr * const Stmt) {
+        if (ThisFinder::Check(Stmt)) {
+            Register(Results, Stmt);
+        }
+        return true;
+    }
+
+private:
+    UsageRefsMap & Results;
+};
+
+// The usage maps of a function body, computed eagerly.
+class Scope {
+public:
+    explicit Scope(clang::Stmt const & Stmt)
+        : Changed()
+        , Used()
+    {
+        {
+            VariableChangeCollector Visitor(Changed);
+            Visitor.TraverseStmt(const_cast<clang::Stmt*>(&Stmt));
+        }
+        {
+            VariableAccessCollector Visitor(Used);
+            Visitor.TraverseStmt(const_cast<clang::Stmt*>(&Stmt));
+        }
+    }
+
+    bool WasChanged(clang::DeclaratorDecl const * const Decl) const {
+        return (Changed.end() != Changed.find(Decl));
+    }
+
+    bool WasReferenced(clang::DeclaratorDecl const * const Decl) const {
+        return (Used.end() != Used.find(Decl));
+    }
+
+    Scope(Scope const &) = delete;
+    Scope & operator=(Scope const &) = delete;
+
+private:
+    UsageRefsMap Changed;
+    UsageRefsMap Used;
+};
+
+
+// Pseudo constness analysis.
+
+bool IsJustAMethod(clang::CXXMethodDecl const * const F) {
+    return
+        (F->isUserProvided())
+    &&  (! F->isVirtual())
+    &&  (! F->isCopyAssignmentOperator())
+    &&  (0 == clang::dyn_cast<clang::CXXConstructorDecl const>(F))
+    &&  (0 == clang::dyn_cast<clang::CXXConversionDecl const>(F))
+    &&  (0 == clang::dyn_cast<clang::CXXDestructorDecl const>(F));
+}
+
+class Analysis
+    : public clang::RecursiveASTVisitor<Analysis> {
+public:
+    Analysis()
+        : clang::RecursiveASTVisitor<Analysis>()
+        , Candidates()
+        , Changed()
+        , ConstCandidates()
+        , StaticCandidates()
+    { }
+
+    Analysis(Analysis const &) = delete;
+    Analysis & operator=(Analysis const &) = delete;
+
+public:
+    bool VisitFunctionDecl(clang::FunctionDecl const * const F) {
+        if (! (F->isThisDeclarationADefinition()))
+            return true;
+        // the parser might have skipped the body.
+        if (F->hasSkippedBody())
+            return true;
+
+        if (auto const D = clang::dyn_cast<clang::CXXMethodDecl const>(F)) {
+            OnCXXMethodDecl(D);
+        } else {
+            OnFunctionDecl(F);
+        }
+        return true;
+    }
+
+    Verdicts GetVerdicts() const {
+        Verdicts Result;
+        std::copy_if(Candidates.begin(), Candidates.end(),
+            std::inserter(Result.ConstVariables, Result.ConstVariables.end()), IsFromMainModule);
+        std::copy_if(ConstCandidates.begin(), ConstCandidates.end(),
+            std::inserter(Result.ConstMethods, Result.ConstMethods.end()), IsFromMainModule);
+        std::copy_if(StaticCandidates.begin(), StaticCandidates.end(),
+            std::inserter(Result.StaticMethods, Result.StaticMethods.end()), IsFromMainModule);
+        return Result;
+    }
+
+private:
+    void OnFunctionDecl(clang::FunctionDecl const * const F) {
+        Scope const Analysis(*(F->getBody()));
+        for (auto && Variable: GetVariablesFromContext(F)) {
+            Eval(Analysis, Variable);
+        }
+    }
+
+    void OnCXXMethodDecl(clang::CXXMethodDecl const * const F) {
+        clang::CXXRecordDecl const * const Parent = F->getParent();
+        clang::CXXRecordDecl const * const RecordDecl =
+            Parent->hasDefinition() ? Parent->getDefinition() : Parent->getCanonicalDecl();
+        Variables const MemberVariables = GetMemberVariablesAndReferences(RecordDecl, F);
+        // check variables first,
+        Scope const Analysis(*(F->getBody()));
+        for (auto && Variable: GetVariablesFromContext(F, IsJustAMethod(F))) {
+            Eval(Analysis, Variable);
+        }
+        for (auto && Variable: MemberVariables) {
+            Eval(Analysis, Variable);
+        }
+        // then check the method itself.
+        if ((! F->isVirtual()) &&
+            (! F->isStatic()) &&
+            F->isUserProvided() &&
+            IsJustAMethod(F)
+        ) {
+            Methods const MemberFunctions = GetMethodsFromRecord(RecordDecl);
+            for (auto && Variable: MemberVariables) {
+                if (Analysis.WasChanged(Variable)) {
+                    return;
+                }
+            }
+            for (auto && Function: MemberFunctions) {
+                if (IsMutatingMethod(Function) && Analysis.WasReferenced(Function)) {
+                    return;
+                }
+            }
+            // if it looks const, it might be even static..
+            bool NotMutateMember = ! ThisFinder::Check(F->getBody());
+            for (auto && Variable: MemberVariables) {
+                if (Analysis.WasReferenced(Variable)) {
+                    NotMutateMember = false;
+                }
+            }
+            for (auto && Function : MemberFunctions) {
+                if (IsMemberMethod(Function) && Analysis.WasReferenced(Function)) {
+                    NotMutateMember = false;
+                }
+            }
+            if (NotMutateMember) {
+                StaticCandidates.insert(F);
+            } else if (! F->isConst()) {
+                ConstCandidates.insert(F);
+            }
+        }
+    }
+
+    void Eval(Scope const & Analysis, clang::DeclaratorDecl const * const V) {
+        if (Analysis.WasChanged(V)) {
+            for (auto && Variable: GetReferedVariables(V)) {
+                Candidates.erase(Variable);
+                Changed.insert(Variable);
+            }
+        } else if (Changed.end() == Changed.find(V)) {
+            if (! V->getType().getNonReferenceType().isConstQualified()) {
+                Candidates.insert(V);
+            }
+        }
+    }
+
+    static bool IsMutatingMethod(clang::CXXMethodDecl const * const F) {
+        return (! F->isStatic()) && (! F->isConst());
+    }
+
+    static bool IsMemberMethod(clang::CXXMethodDecl const * const F) {
+        return (! F->isStatic());
+    }
+
+private:
+    Variables Candidates;
+    Variables Changed;
+    Methods ConstCandidates;
+    Methods StaticCandidates;
+};
+
+} // namespace reference
+} // namespace anonymous
+
+
+Verdicts ReferenceVerdicts(clang::ASTContext & Ctx) {
+    reference::Analysis Visitor;
+    Visitor.TraverseDecl(Ctx.getTranslationUnitDecl());
+    return Visitor.GetVerdicts();
+}
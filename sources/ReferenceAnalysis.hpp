@@ -0,0 +1,44 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "DeclarationCollector.hpp"
+
+#include <clang/AST/AST.h>
+
+
+// The verdicts of the pseudo constness analysis on a translation unit.
+// (Only the declarations from the main file are listed, these are the
+// ones which are reported.)
+struct Verdicts {
+    Variables ConstVariables;
+    Methods ConstMethods;
+    Methods StaticMethods;
+};
+
+// Run the reference engine on the translation unit.
+//
+// The reference engine is the straightforward implementation of the pseudo
+// constness analysis: the usage maps are computed eagerly, nothing is cached
+// or limited. It is kept as it is, to check the optimised engine against it.
+// Do not optimise this code, change it only when the intended findings are
+// changing.
+Verdicts ReferenceVerdicts(clang::ASTContext &);
@@ -0,0 +1,274 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "ResultCache.hpp"
+
+#include <set>
+
+#include <llvm/ADT/SmallString.h>
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/FileSystem.h>
+#include <llvm/Support/MD5.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/Path.h>
+#include <llvm/Support/raw_ostream.h>
+#include <clang/Basic/FileManager.h>
+
+
+namespace {
+
+static char const * const CacheHeader = "constantine-cache 1";
+
+// The content of a file is shared by its entries, a file which was
+// entered multiple times is hashed only at its first entry.
+typedef std::set<clang::SrcMgr::ContentCache const *> HashedFiles;
+
+void HashFile(llvm::MD5 & Hash, clang::SrcMgr::SLocEntry const & Entry, HashedFiles & Seen) {
+    clang::SrcMgr::ContentCache const * const Content =
+        Entry.getFile().getContentCache();
+    if (! Seen.insert(Content).second)
+        return;
+
+    if (llvm::MemoryBuffer const * const Buffer = Content->getRawBuffer()) {
+        Hash.update(Buffer->getBufferIdentifier());
+        Hash.update(Buffer->getBuffer());
+    } else if (clang::FileEntry const * const File = Content->OrigEntry) {
+        Hash.update(File->getName());
+        Hash.update(std::to_string(File->getSize()));
+        Hash.update(std::to_string(File->getModificationTime()));
+    }
+}
+
+// The baseline and the profile can be big, those are identified by size
+// and time.
+void HashInputFile(llvm::MD5 & Hash, std::string const & Path) {
+    llvm::sys::fs::file_status Status;
+    if (llvm::sys::fs::status(Path, Status))
+        return;
+    Hash.update(std::to_string(Status.getSize()));
+    Hash.update(std::to_string(Status.getLastModificationTime().toEpochTime()));
+}
+
+std::string ComputeKey(clang::SourceManager const & SM, Options const & O) {
+    llvm::MD5 Hash;
+    Hash.update(CONSTANTINE_VERSION);
+    Hash.update(OptionsFingerprint(O));
+    if (! O.BaselinePath.empty()) {
+        HashInputFile(Hash, O.BaselinePath);
+    }
+    if (! O.ProfilePath.empty()) {
+        HashInputFile(Hash, O.ProfilePath);
+    }
+    // Every file (including the predefines buffer) which was entered by
+    // the preprocessor, in the order of entering.
+    HashedFiles Seen;
+    for (unsigned It = 0, End = SM.local_sloc_entry_size(); It != End; ++It) {
+        clang::SrcMgr::SLocEntry const & Entry = SM.getLocalSLocEntry(It);
+        if (Entry.isFile()) {
+            HashFile(Hash, Entry, Seen);
+        }
+    }
+    // Files which are coming from precompiled headers or AST files. Their
+    // content is not loaded, these are identified by name, size and time.
+    for (unsigned It = 0, End = SM.loaded_sloc_entry_size(); It != End; ++It) {
+        clang::SrcMgr::SLocEntry const & Entry = SM.getLoadedSLocEntry(It);
+        if (Entry.isFile()) {
+            HashFile(Hash, Entry, Seen);
+        }
+    }
+    llvm::MD5::MD5Result Result;
+    Hash.final(Result);
+    llvm::SmallString<32> Hex;
+    llvm::MD5::stringifyResult(Result, Hex);
+    return Hex.str();
+}
+
+std::string GetCachePath(std::string const & Directory, std::string const & Key) {
+    llvm::SmallString<256> Result(Directory);
+    llvm::sys::path::append(Result, Key + ".constantine");
+    return Result.str();
+}
+
+// Write into a temporary file and move it to the final place, so
+// concurrent compilations never see a partially written file.
+bool WriteFile(std::string const & Path, llvm::StringRef const Content) {
+    int FD = -1;
+    llvm::SmallString<256> TemporaryPath;
+    if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%%%", FD, TemporaryPath))
+        return false;
+    {
+        llvm::raw_fd_ostream Out(FD, true);
+        Out << Content;
+    }
+    if (llvm::sys::fs::rename(TemporaryPath, Path)) {
+        llvm::sys::fs::remove(TemporaryPath);
+        return false;
+    }
+    return true;
+}
+
+bool IsStorable(llvm::StringRef const Field) {
+    return (llvm::StringRef::npos == Field.find_first_of("\t\n"));
+}
+
+bool ParseLine(llvm::StringRef const Line, CachedDiagnostic & Out) {
+    llvm::SmallVector<llvm::StringRef, 5> Fields;
+    Line.split(Fields, '\t', 4);
+    if (5 != Fields.size())
+        return false;
+
+    unsigned Level = 0;
+    if (Fields[0].getAsInteger(10, Level) ||
+        Fields[1].getAsInteger(10, Out.Line) ||
+        Fields[2].getAsInteger(10, Out.Column)) {
+        return false;
+    }
+    if (Level > clang::DiagnosticsEngine::Fatal)
+        return false;
+
+    Out.Level = static_cast<clang::DiagnosticsEngine::Level>(Level);
+    Out.File = Fields[3];
+    Out.Message = Fields[4];
+    return true;
+}
+
+} // namespace anonymous
+
+
+ResultCache::ResultCache(std::string const & Dir, clang::SourceManager const & SM, Options const & O)
+    : Directory(Dir)
+    , Path(GetCachePath(Dir, ComputeKey(SM, O)))
+    , OutputPath(Path + "-output")
+{ }
+
+bool ResultCache::Replay(clang::DiagnosticsEngine & DE, clang::SourceManager & SM,
+                         std::string const & Output) const {
+    auto const Buffer = llvm::MemoryBuffer::getFile(Path);
+    if (! Buffer)
+        return false;
+    if (! Output.empty()) {
+        auto const Stored = llvm::MemoryBuffer::getFile(OutputPath);
+        if ((! Stored) || (! WriteFile(Output, (*Stored)->getBuffer())))
+            return false;
+    }
+
+    CachedDiagnostics Entries;
+    {
+        llvm::SmallVector<llvm::StringRef, 32> Lines;
+        (*Buffer)->getBuffer().split(Lines, '\n', -1, false);
+        if (Lines.empty() || (Lines.front() != CacheHeader))
+            return false;
+
+        for (auto It = Lines.begin() + 1, End = Lines.end(); It != End; ++It) {
+            CachedDiagnostic Entry;
+            if (! ParseLine(*It, Entry))
+                return false;
+            Entries.push_back(Entry);
+        }
+    }
+    for (auto && Entry : Entries) {
+        clang::SourceLocation Location;
+        if (! Entry.File.empty()) {
+            if (clang::FileEntry const * const File = SM.getFileManager().getFile(Entry.File)) {
+                Location = SM.translateFileLineCol(File, Entry.Line, Entry.Column);
+            }
+        }
+        unsigned const Id = DE.getCustomDiagID(Entry.Level, "%0");
+        clang::DiagnosticBuilder const DB = DE.Report(Location, Id);
+        DB << Entry.Message;
+        DB.setForceEmit();
+    }
+    return true;
+}
+
+void ResultCache::Store(CachedDiagnostics const & Entries, std::string const & Output) const {
+    std::string Content = CacheHeader;
+    for (auto && Entry : Entries) {
+        // rather not cache than store something unparsable.
+        if (! (IsStorable(Entry.File) && IsStorable(Entry.Message)))
+            return;
+
+        Content += '\n';
+        Content += std::to_string(static_cast<unsigned>(Entry.Level));
+        Content += '\t';
+        Content += std::to_string(Entry.Line);
+        Content += '\t';
+        Content += std::to_string(Entry.Column);
+        Content += '\t';
+        Content += Entry.File;
+        Content += '\t';
+        Content += Entry.Message;
+    }
+    if (llvm::sys::fs::create_directories(Directory))
+        return;
+
+    // the output goes first, the entry is not a hit without it.
+    if (! Output.empty()) {
+        auto const Committed = llvm::MemoryBuffer::getFile(Output);
+        if ((! Committed) || (! WriteFile(OutputPath, (*Committed)->getBuffer())))
+            return;
+    }
+    WriteFile(Path, Content);
+}
+
+
+DiagnosticRecorder::DiagnosticRecorder(clang::DiagnosticsEngine & DE, CachedDiagnostics & Out)
+    : clang::DiagnosticConsumer()
+    , Engine(DE)
+    , Owned(DE.ownsClient() ? DE.takeClient() : nullptr)
+    , Next(DE.getClient())
+    , Results(Out)
+{
+    Engine.setClient(this, false);
+}
+
+DiagnosticRecorder::~DiagnosticRecorder() {
+    if (Owned) {
+        Engine.setClient(Owned.release(), true);
+    } else {
+        Engine.setClient(Next, false);
+    }
+}
+
+void DiagnosticRecorder::HandleDiagnostic(clang::DiagnosticsEngine::Level Level, clang::Diagnostic const & Info) {
+    clang::DiagnosticConsumer::HandleDiagnostic(Level, Info);
+
+    CachedDiagnostic Entry;
+    Entry.Level = Level;
+    Entry.Line = 0;
+    Entry.Column = 0;
+    {
+        llvm::SmallString<256> Message;
+        Info.FormatDiagnostic(Message);
+        Entry.Message = Message.str();
+    }
+    if (Info.getLocation().isValid() && Info.hasSourceManager()) {
+        clang::SourceManager const & SM = Info.getSourceManager();
+        clang::SourceLocation const Location = SM.getExpansionLoc(Info.getLocation());
+        Entry.File = SM.getFilename(Location);
+        Entry.Line = SM.getExpansionLineNumber(Location);
+        Entry.Column = SM.getExpansionColumnNumber(Location);
+    }
+    Results.push_back(Entry);
+
+    if (Next) {
+        Next->HandleDiagnostic(Level, Info);
+    }
+}
@@ -0,0 +1,88 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "Options.hpp"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <clang/Basic/Diagnostic.h>
+#include <clang/Basic/SourceManager.h>
+
+
+// One diagnostic which was emitted by the analysis, stored in a form
+// which does not depend on the current compilation.
+struct CachedDiagnostic {
+    clang::DiagnosticsEngine::Level Level;
+    std::string File;
+    unsigned Line;
+    unsigned Column;
+    std::string Message;
+};
+
+typedef std::vector<CachedDiagnostic> CachedDiagnostics;
+
+// Whole translation unit result cache. The key is made from the plugin
+// version, the plugin options and the content of every file which was
+// read by the preprocessor. (These together determine the preprocessed
+// content, therefore the findings too.)
+//
+// When the structured output is written, a copy of it is stored next to
+// the diagnostics, and restored on cache hit. (An entry without output
+// copy is a miss for the runs which are writing output.)
+class ResultCache {
+public:
+    ResultCache(std::string const & Directory, clang::SourceManager const &, Options const &);
+
+    // Emit the stored diagnostics again, and restore the output file when
+    // its path is given. Returns false on cache miss.
+    bool Replay(clang::DiagnosticsEngine &, clang::SourceManager &, std::string const & Output) const;
+    void Store(CachedDiagnostics const &, std::string const & Output) const;
+
+    ResultCache(ResultCache const &) = delete;
+    ResultCache & operator=(ResultCache const &) = delete;
+
+private:
+    std::string const Directory;
+    std::string const Path;
+    std::string const OutputPath;
+};
+
+// While alive, it keeps a copy of every diagnostic which goes through the
+// engine, and forwards them to the original consumer.
+class DiagnosticRecorder : public clang::DiagnosticConsumer {
+public:
+    DiagnosticRecorder(clang::DiagnosticsEngine &, CachedDiagnostics &);
+    ~DiagnosticRecorder() override;
+
+    void HandleDiagnostic(clang::DiagnosticsEngine::Level, clang::Diagnostic const &) override;
+
+    DiagnosticRecorder(DiagnosticRecorder const &) = delete;
+    DiagnosticRecorder & operator=(DiagnosticRecorder const &) = delete;
+
+private:
+    clang::DiagnosticsEngine & Engine;
+    std::unique_ptr<clang::DiagnosticConsumer> Owned;
+    clang::DiagnosticConsumer * const Next;
+    CachedDiagnostics & Results;
+};
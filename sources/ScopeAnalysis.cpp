@@ -20,11 +20,17 @@
 #include "ScopeAnalysis.hpp"
 #include "IsCXXThisExpr.hpp"
 #include "IsFromMainModule.hpp"
+#include "SourceOrder.hpp"
+#include "Statistics.hpp"
+#include "StmtWalker.hpp"
 
 #include <clang/AST/RecursiveASTVisitor.h>
 #include <clang/Basic/Diagnostic.h>
 
+#include <algorithm>
 #include <functional>
+#include <initializer_list>
+#include <vector>
 
 
 namespace {
@@ -36,12 +42,20 @@ static clang::SourceRange const NoRange = clang::SourceRange();
 class UsageExtractor
     : public clang::RecursiveASTVisitor<UsageExtractor> {
 public:
-    UsageExtractor(UsageRefsMap & Out, clang::QualType const & InType)
+    UsageExtractor(UsageRefsMap & Out, clang::QualType const & InType,
+                   Variables const * const In)
         : clang::RecursiveASTVisitor<UsageExtractor>()
         , Results(Out)
         , State(InType, NoRange)
+        , Interest(In)
+        , Found(0)
     { }
 
+    // The number of interesting variables got their first entry.
+    std::size_t GetFound() const {
+        return Found;
+    }
+
     UsageExtractor(UsageExtractor const &) = delete;
     UsageExtractor & operator=(UsageExtractor const &) = delete;
 
@@ -62,9 +76,13 @@ private:
             if (Results.end() == It) {
                 auto const R = Results.insert(UsageRefsMap::value_type(D, UsageRefs()));
                 It = R.first;
+                if (Interest && (Interest->end() != Interest->find(D))) {
+                    ++Found;
+                }
             }
             UsageRefs & Ls = It->second;
             Ls.push_back(State);
+            Statistics::Count(UsageEntries);
         }
         // reset the state for the next call
         State = std::make_tuple(NoType, NoRange);
@@ -72,6 +90,11 @@ private:
 
 public:
     // public visitor method.
+    bool VisitStmt(clang::Stmt const *) {
+        Statistics::Count(UsageNodesVisited);
+        return true;
+    }
+
     bool VisitCastExpr(clang::CastExpr const * const E) {
         Capture(E);
         return true;
@@ -100,18 +123,40 @@ public:
         return true;
     }
 
+    // Dispatch of the iterative walk, in the order of the visitor.
+    bool VisitNode(clang::Stmt const * const S) {
+        VisitStmt(S);
+        if (auto const E = clang::dyn_cast<clang::CastExpr const>(S)) {
+            VisitCastExpr(E);
+        } else if (auto const E = clang::dyn_cast<clang::UnaryOperator const>(S)) {
+            VisitUnaryOperator(E);
+        } else if (auto const E = clang::dyn_cast<clang::DeclRefExpr const>(S)) {
+            VisitDeclRefExpr(E);
+        } else if (auto const E = clang::dyn_cast<clang::MemberExpr const>(S)) {
+            VisitMemberExpr(E);
+        }
+        return true;
+    }
+
 private:
     UsageRefsMap & Results;
     UsageRef State;
+    Variables const * const Interest;
+    std::size_t Found;
 };
 
-void Register(UsageRefsMap & Results,
-              clang::Expr const * E,
-              clang::QualType const & Type = clang::QualType()) {
+// Returns the number of interesting variables which were not in the
+// results before.
+std::size_t Register(UsageRefsMap & Results,
+                     clang::Expr const * E,
+                     clang::QualType const & Type = clang::QualType(),
+                     Variables const * const Interest = nullptr) {
+    Statistics::Count(RegisterCalls);
     clang::Stmt const * const Stmt = E;
 
-    UsageExtractor Visitor(Results, Type);
-    Visitor.TraverseStmt(const_cast<clang::Stmt*>(Stmt));
+    UsageExtractor Visitor(Results, Type, Interest);
+    StmtWalker::Walk(Visitor, Stmt);
+    return Visitor.GetFound();
 }
 
 template <unsigned N>
@@ -131,22 +176,54 @@ void DumpUsageMapEntry(UsageRefsMap::value_type const & Var
     }
 }
 
+// The map is ordered by pointer value, the entries are reported in the
+// source order of the variables.
+template <unsigned N>
+void DumpUsageMap(UsageRefsMap const & Facts
+           , char const (&Message)[N]
+           , clang::DiagnosticsEngine & DE) {
+    std::vector<clang::DeclaratorDecl const *> Keys;
+    Keys.reserve(Facts.size());
+    for (auto && Entry : Facts) {
+        Keys.push_back(Entry.first);
+    }
+    std::stable_sort(Keys.begin(), Keys.end(), IsBeforeInSource);
+    for (auto && Key : Keys) {
+        DumpUsageMapEntry(*Facts.find(Key), Message, DE);
+    }
+}
+
 
 // Collect all variables which were mutated in the given scope.
 // (The scope is given by the TraverseStmt method.)
+//
+// When the interesting variables are given, the traversal stops as soon
+// as all of them were found changed.
 class VariableChangeCollector
     : public clang::RecursiveASTVisitor<VariableChangeCollector> {
 public:
-    VariableChangeCollector(UsageRefsMap & Out)
+    VariableChangeCollector(UsageRefsMap & Out, Variables const * const In)
         : clang::RecursiveASTVisitor<VariableChangeCollector>()
         , Results(Out)
+        , Interest(In)
+        , Missing(In ? In->size() : 0)
+        , Saturated(false)
     { }
 
+    bool WasStoppedEarly() const {
+        return Saturated;
+    }
+
 public:
+    bool VisitStmt(clang::Stmt const *) {
+        Statistics::Count(ChangeNodesVisited);
+        return true;
+    }
+
     // Assignments are mutating variables.
     bool VisitBinaryOperator(clang::BinaryOperator const * const Stmt) {
         if (Stmt->isAssignmentOp()) {
-            Register(Results, Stmt->getLHS());
+            return Collect(Stmt->getLHS());
         }
         return true;
     }
@@ -154,7 +231,7 @@ public:
     // Inc/Dec-rement operator does mutate variables.
     bool VisitUnaryOperator(clang::UnaryOperator const * const Stmt) {
         if (Stmt->isIncrementDecrementOp()) {
-            Register(Results, Stmt->getSubExpr());
+            return Collect(Stmt->getSubExpr());
         }
         return true;
     }
@@ -167,7 +244,9 @@ public:
         for (auto It = 0u; It < Args; ++It) {
             auto const P = F->getParamDecl(It);
             if (IsNonConstReferenced(P->getType())) {
-                Register(Results, Stmt->getArg(It), (*(P->getType())).getPointeeType());
+                if (! Collect(Stmt->getArg(It), (*(P->getType())).getPointeeType())) {
+                    return false;
+                }
             }
         }
         return true;
@@ -186,8 +265,10 @@ public:
                 auto const P = F->getParamDecl(It);
                 if (IsNonConstReferenced(P->getType())) {
                     assert(It + Offset <= Stmt->getNumArgs());
-                    Register(Results, Stmt->getArg(It + Offset),
-                                 (*(P->getType())).getPointeeType());
+                    if (! Collect(Stmt->getArg(It + Offset),
+                                  (*(P->getType())).getPointeeType())) {
+                        return false;
+                    }
                 }
             }
         }
@@ -198,7 +279,7 @@ public:
     bool VisitCXXMemberCallExpr(clang::CXXMemberCallExpr const * const Stmt) {
         if (auto const MD = Stmt->getMethodDecl()) {
             if ((! MD->isConst()) && (! MD->isStatic())) {
-                Register(Results, Stmt->getImplicitObjectArgument());
+                return Collect(Stmt->getImplicitObjectArgument());
             }
         }
         return true;
@@ -211,7 +292,7 @@ public:
         if (auto const F = Stmt->getDirectCallee()) {
             if (auto const MD = clang::dyn_cast<clang::CXXMethodDecl const>(F)) {
                 if ((! MD->isConst()) && (! MD->isStatic()) && (0 < Stmt->getNumArgs())) {
-                    Register(Results, Stmt->getArg(0));
+                    return Collect(Stmt->getArg(0));
                 }
             }
         }
@@ -223,12 +304,26 @@ public:
         auto const Args = Stmt->getNumPlacementArgs();
         for (auto It = 0u; It < Args; ++It) {
             // FIXME: not all placement argument are mutating.
-            Register(Results, Stmt->getPlacementArg(It));
+            if (! Collect(Stmt->getPlacementArg(It))) {
+                return false;
+            }
         }
         return true;
     }
 
 private:
+    // Register the usage and tell the traversal should go on or not.
+    bool Collect(clang::Expr const * const E,
+                 clang::QualType const & Type = clang::QualType()) {
+        // only a new entry can make the interesting set complete
+        auto const Found = Register(Results, E, Type, Interest);
+        if (Interest && (0 != Found)) {
+            Missing -= Found;
+            Saturated = (0 == Missing);
+        }
+        return ! Saturated;
+    }
+
     static bool IsNonConstReferenced(clang::QualType const & Decl) {
         return
             ((*Decl).isReferenceType() || (*Decl).isPointerType())
@@ -244,6 +339,9 @@ private:
 
 private:
     UsageRefsMap & Results;
+    Variables const * const Interest;
+    std::size_t Missing;
+    bool Saturated;
 };
 
 // Collect all variables which were accessed in the given scope.
@@ -257,6 +355,11 @@ public:
     { }
 
 public:
+    bool VisitStmt(clang::Stmt const *) {
+        Statistics::Count(AccessNodesVisited);
+        return true;
+    }
+
     bool VisitDeclRefExpr(clang::DeclRefExpr const * const Stmt) {
         Register(Results, Stmt);
         return true;
@@ -273,37 +376,172 @@ private:
     UsageRefsMap & Results;
 };
 
+// Collect the loop statements of the given scope.
+class LoopCollector
+    : public clang::RecursiveASTVisitor<LoopCollector> {
+public:
+    LoopCollector(std::vector<clang::Stmt const *> & Out)
+        : clang::RecursiveASTVisitor<LoopCollector>()
+        , Results(Out)
+    { }
+
+public:
+    bool VisitForStmt(clang::ForStmt const * const Stmt) {
+        Results.push_back(Stmt);
+        return true;
+    }
+
+    bool VisitCXXForRangeStmt(clang::CXXForRangeStmt const * const Stmt) {
+        Results.push_back(Stmt);
+        return true;
+    }
+
+    bool VisitWhileStmt(clang::WhileStmt const * const Stmt) {
+        Results.push_back(Stmt);
+        return true;
+    }
+
+    bool VisitDoStmt(clang::DoStmt const * const Stmt) {
+        Results.push_back(Stmt);
+        return true;
+    }
+
+private:
+    std::vector<clang::Stmt const *> & Results;
+};
+
 } // namespace anonymous
 
+ScopeAnalysis::ScopeAnalysis(clang::Stmt const & Stmt)
+    : Body(&Stmt)
+    , Limited(false)
+    , Interest()
+    , ChangedProgress(NotComputed)
+    , UsedProgress(NotComputed)
+    , Changed()
+    , Used()
+    , LoopsCollected(false)
+    , Loops()
+{ }
+
 ScopeAnalysis ScopeAnalysis::AnalyseThis(clang::Stmt const & Stmt) {
-    ScopeAnalysis Result;
-    {
-        VariableChangeCollector Visitor(Result.Changed);
-        Visitor.TraverseStmt(const_cast<clang::Stmt*>(&Stmt));
+    return ScopeAnalysis(Stmt);
+}
+
+void ScopeAnalysis::LimitChangesTo(Variables const & Candidates) {
+    // too late to limit, the facts are already there
+    if (NotComputed != ChangedProgress)
+        return;
+
+    Limited = true;
+    Interest = Candidates;
+}
+
+UsageRefsMap const & ScopeAnalysis::GetChanged(bool const NeedComplete) const {
+    bool const Missing =
+        (NotComputed == ChangedProgress) ||
+        (NeedComplete && (Partial == ChangedProgress));
+    if (Missing) {
+        Statistics::PhaseTimer const Timer(ScopeAnalysisPhase);
+        Changed.clear();
+        if (Limited && (! NeedComplete) && Interest.empty()) {
+            // nobody is going to ask, nothing to collect.
+            ChangedProgress = Partial;
+        } else {
+            bool const Limit = Limited && (! NeedComplete);
+            VariableChangeCollector Visitor(Changed, Limit ? &Interest : nullptr);
+            Visitor.TraverseStmt(const_cast<clang::Stmt*>(Body));
+            ChangedProgress = Visitor.WasStoppedEarly() ? Partial : Complete;
+        }
     }
-    {
-        VariableAccessCollector Visitor(Result.Used);
-        Visitor.TraverseStmt(const_cast<clang::Stmt*>(&Stmt));
+    return Changed;
+}
+
+UsageRefsMap const & ScopeAnalysis::GetUsed() const {
+    if (NotComputed == UsedProgress) {
+        Statistics::PhaseTimer const Timer(ScopeAnalysisPhase);
+        VariableAccessCollector Visitor(Used);
+        Visitor.TraverseStmt(const_cast<clang::Stmt*>(Body));
+        UsedProgress = Complete;
     }
-    return Result;
+    return Used;
+}
+
+std::vector<clang::Stmt const *> const & ScopeAnalysis::GetLoops() const {
+    if (! LoopsCollected) {
+        Statistics::PhaseTimer const Timer(ScopeAnalysisPhase);
+        LoopCollector Visitor(Loops);
+        Visitor.TraverseStmt(const_cast<clang::Stmt*>(Body));
+        LoopsCollected = true;
+    }
+    return Loops;
 }
 
 bool ScopeAnalysis::WasChanged(clang::DeclaratorDecl const * const Decl) const {
-    return (Changed.end() != Changed.find(Decl));
+    {
+        UsageRefsMap const & Facts = GetChanged(false);
+        if (Facts.end() != Facts.find(Decl))
+            return true;
+    }
+    // the partial result is exact only for the interesting variables.
+    if ((Partial == ChangedProgress) && (Interest.end() == Interest.find(Decl))) {
+        UsageRefsMap const & Facts = GetChanged(true);
+        return (Facts.end() != Facts.find(Decl));
+    }
+    return false;
 }
 
 bool ScopeAnalysis::WasReferenced(clang::DeclaratorDecl const * const Decl) const {
-    return (Used.end() != Used.find(Decl));
+    UsageRefsMap const & Facts = GetUsed();
+    return (Facts.end() != Facts.find(Decl));
 }
 
-void ScopeAnalysis::DebugChanged(clang::DiagnosticsEngine & DE) const {
-    for (auto const Entry : Changed) {
-        DumpUsageMapEntry(Entry, "variable '%0' with type '%1' was changed", DE);
+unsigned ScopeAnalysis::GetLoopDepth(clang::DeclaratorDecl const * const Decl) const {
+    UsageRefsMap const & Facts = GetUsed();
+    auto const It = Facts.find(Decl);
+    if ((Facts.end() == It) || GetLoops().empty())
+        return 0;
+
+    clang::SourceManager const & SM = Decl->getASTContext().getSourceManager();
+    unsigned Result = 0;
+    for (auto && Usage : It->second) {
+        clang::SourceLocation const Location = SM.getExpansionLoc(std::get<1>(Usage).getBegin());
+        unsigned Depth = 0;
+        for (auto && Loop : Loops) {
+            if (SM.isPointWithin(Location,
+                                 SM.getExpansionLoc(Loop->getLocStart()),
+                                 SM.getExpansionLoc(Loop->getLocEnd()))) {
+                ++Depth;
+            }
+        }
+        Result = std::max(Result, Depth);
     }
+    return Result;
 }
 
-void ScopeAnalysis::DebugReferenced(clang::DiagnosticsEngine & DE) const {
-    for (auto const Entry : Used) {
-        DumpUsageMapEntry(Entry, "symbol '%0' was used with type '%1'", DE);
+std::size_t ScopeAnalysis::GetFootprint() const {
+    std::size_t Result = EstimateFootprint(Interest) + Loops.size() * sizeof(clang::Stmt const *);
+    for (auto const Facts : { &Changed, &Used }) {
+        for (auto && Entry : *Facts) {
+            Result += sizeof(Entry) + TreeNodeOverhead;
+            Result += Entry.second.size() * (sizeof(UsageRef) + ListNodeOverhead);
+        }
     }
+    return Result;
+}
+
+UsageRefsMap const & ScopeAnalysis::GetAllChanges() const {
+    return GetChanged(true);
+}
+
+UsageRefsMap const & ScopeAnalysis::GetAllUsages() const {
+    return GetUsed();
+}
+
+void ScopeAnalysis::DebugChanged(clang::DiagnosticsEngine & DE) const {
+    DumpUsageMap(GetChanged(true), "variable '%0' with type '%1' was changed", DE);
+}
+
+void ScopeAnalysis::DebugReferenced(clang::DiagnosticsEngine & DE) const {
+    DumpUsageMap(GetUsed(), "symbol '%0' was used with type '%1'", DE);
 }
@@ -19,9 +19,13 @@
 
 #pragma once
 
+#include "DeclarationCollector.hpp"
+
+#include <cstddef>
 #include <utility>
 #include <list>
 #include <map>
+#include <vector>
 
 #include <clang/AST/AST.h>
 
@@ -33,18 +37,37 @@ typedef std::map<clang::DeclaratorDecl const *, UsageRefs> UsageRefsMap;
 
 // This class tracks the usage of variables in a statement body to see
 // if they are never written to, implying that they constant.
+//
+// The facts are computed on demand: the body is walked for changes only
+// when the first change query arrives, and for references only when the
+// first reference query arrives.
 class ScopeAnalysis {
 public:
     static ScopeAnalysis AnalyseThis(clang::Stmt const &);
 
+    // Promise that only these variables will be asked by WasChanged. The
+    // change collection then stops as soon as all of them were changed.
+    // (Asking about other variables is still correct, but more expensive.)
+    void LimitChangesTo(Variables const &);
+
     bool WasChanged(clang::DeclaratorDecl const *) const;
     bool WasReferenced(clang::DeclaratorDecl const *) const;
 
+    // The deepest loop nesting of the references to the variable. (Zero
+    // when it is not referenced inside a loop of the body.)
+    unsigned GetLoopDepth(clang::DeclaratorDecl const *) const;
+
+    // The complete facts of the body, for the library interface.
+    UsageRefsMap const & GetAllChanges() const;
+    UsageRefsMap const & GetAllUsages() const;
+
     void DebugChanged(clang::DiagnosticsEngine &) const;
     void DebugReferenced(clang::DiagnosticsEngine &) const;
 
+    // Estimated heap bytes of the facts computed so far.
+    std::size_t GetFootprint() const;
+
 public:
-    ScopeAnalysis() = default;
     ScopeAnalysis(ScopeAnalysis &&) = default;
     ScopeAnalysis & operator=(ScopeAnalysis &&) = default;
 
@@ -52,6 +75,27 @@ public:
     ScopeAnalysis & operator=(ScopeAnalysis const &) = delete;
 
 private:
-    UsageRefsMap Changed;
-    UsageRefsMap Used;
+    explicit ScopeAnalysis(clang::Stmt const &);
+
+    enum Progress
+        { NotComputed
+        , Partial
+        , Complete
+        };
+
+    UsageRefsMap const & GetChanged(bool NeedComplete) const;
+    UsageRefsMap const & GetUsed() const;
+    std::vector<clang::Stmt const *> const & GetLoops() const;
+
+private:
+    clang::Stmt const * Body;
+    bool Limited;
+    Variables Interest;
+
+    mutable Progress ChangedProgress;
+    mutable Progress UsedProgress;
+    mutable UsageRefsMap Changed;
+    mutable UsageRefsMap Used;
+    mutable bool LoopsCollected;
+    mutable std::vector<clang::Stmt const *> Loops;
 };
@@ -0,0 +1,69 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+#include <clang/AST/AST.h>
+
+
+// Order of the declarations by their location in the translation unit.
+// Declarations from the same (macro expanded) location are ordered by the
+// location of their name, and then by their qualified name.
+//
+// The containers are ordered by pointer value, which depends on allocation
+// addresses. Reports are sorted by this, to be the same in every run.
+inline
+bool IsBeforeInSource(clang::Decl const * const Lhs, clang::Decl const * const Rhs) {
+    if (Lhs == Rhs)
+        return false;
+
+    auto const & SM = Lhs->getASTContext().getSourceManager();
+    auto const Before = [&SM](clang::SourceLocation L, clang::SourceLocation R) -> int {
+        L = SM.getExpansionLoc(L);
+        R = SM.getExpansionLoc(R);
+        if (L == R)
+            return 0;
+        // invalid locations go first.
+        if (L.isInvalid() || R.isInvalid())
+            return L.isInvalid() ? -1 : 1;
+        return SM.isBeforeInTranslationUnit(L, R) ? -1 : 1;
+    };
+    if (int const Start = Before(Lhs->getLocStart(), Rhs->getLocStart()))
+        return Start < 0;
+    if (int const Name = Before(Lhs->getLocation(), Rhs->getLocation()))
+        return Name < 0;
+
+    auto const LhsNamed = clang::dyn_cast<clang::NamedDecl const>(Lhs);
+    auto const RhsNamed = clang::dyn_cast<clang::NamedDecl const>(Rhs);
+    if (LhsNamed && RhsNamed)
+        return LhsNamed->getQualifiedNameAsString() < RhsNamed->getQualifiedNameAsString();
+    return false;
+}
+
+// Copy the elements of the container in source order.
+template <typename Container>
+std::vector<typename Container::value_type> SortBySource(Container const & Input) {
+    std::vector<typename Container::value_type> Result(Input.begin(), Input.end());
+    std::stable_sort(Result.begin(), Result.end(), IsBeforeInSource);
+    return Result;
+}
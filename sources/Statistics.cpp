@@ -0,0 +1,284 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Statistics.hpp"
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <string>
+
+#include <llvm/Support/Format.h>
+
+
+namespace {
+
+thread_local Statistics * Active = nullptr;
+
+char const * const PhaseNames[PhaseCount] =
+    { "Module traversal"
+    , "Scope analysis"
+    , "Declaration collector queries"
+    , "Alias walk (GetReferedVariables)"
+    , "Reporting"
+    };
+
+char const * const CounterNames[CounterCount] =
+    { "functions"
+    , "module-nodes"
+    , "register-calls"
+    , "candidates-inserted"
+    , "candidates-erased"
+    , "change-nodes"
+    , "access-nodes"
+    , "usage-nodes"
+    , "this-search-nodes"
+    , "usage-entries"
+    , "records-walked"
+    , "declarations-inserted"
+    , "alias-steps"
+    , "referee-steps"
+    , "findings-suppressed"
+    , "instantiations-skipped"
+    };
+
+char const * const CounterDescriptions[CounterCount] =
+    { "Number of functions analysed"
+    , "Number of AST nodes visited by the module traversal"
+    , "Number of usage register calls"
+    , "Number of candidates inserted"
+    , "Number of candidates erased"
+    , "Number of AST nodes visited by the change collector"
+    , "Number of AST nodes visited by the access collector"
+    , "Number of AST nodes visited by the usage extractor"
+    , "Number of AST nodes visited by the 'this' search"
+    , "Number of usage entries recorded"
+    , "Number of records walked in base class search"
+    , "Number of declarations inserted by the collector"
+    , "Number of steps in the alias walk"
+    , "Number of steps in the referee expression search"
+    , "Number of findings suppressed by the baseline"
+    , "Number of template instantiations not analysed"
+    };
+
+char const * const FootprintDescriptions[FootprintCount] =
+    { "Usage maps of a function"
+    , "Candidate sets"
+    , "Record summaries"
+    };
+
+char const * const LargestDescriptions[FootprintCount] =
+    { "Top functions by usage map footprint"
+    , nullptr
+    , "Top records by summary footprint"
+    };
+
+// The length of the top lists.
+std::size_t const LargestCount = 10;
+
+// The counters which are counting AST nodes (or declarations) walked for
+// the given unit.
+std::initializer_list<Counter> const CostCounters[CostKindCount] =
+    { { ChangeNodesVisited, AccessNodesVisited, UsageNodesVisited, ThisSearchNodesVisited }
+    , { RecordsWalked, DeclarationsInserted }
+    };
+
+} // namespace anonymous
+
+
+Statistics::Statistics(bool const WithTimers, bool const WithFootprint, unsigned const TopCosts)
+    : Group()
+    , Timers()
+    , Depth()
+    , Counters()
+    , WithFootprint(WithFootprint)
+    , Current()
+    , Peak()
+    , PeakTotal(0)
+    , Largest()
+    , TopCosts(TopCosts)
+    , Costs()
+{
+    if (WithTimers) {
+        Group.reset(new llvm::TimerGroup("Constantine"));
+        for (unsigned It = 0; It < PhaseCount; ++It) {
+            Timers[It].reset(new llvm::Timer(PhaseNames[It], *Group));
+        }
+    }
+}
+
+void Statistics::Count(Counter const Which, std::uint64_t const Value) {
+    if (Active) {
+        Active->Counters[Which] += Value;
+    }
+}
+
+bool Statistics::IsTrackingFootprint() {
+    return Active && Active->WithFootprint;
+}
+
+void Statistics::SetFootprint(Footprint const Which, std::size_t const Bytes) {
+    if (IsTrackingFootprint()) {
+        Active->Current[Which] = Bytes;
+        Active->Peak[Which] = std::max(Active->Peak[Which], Bytes);
+    }
+}
+
+void Statistics::Attribute(Footprint const Which, std::string const & Name, std::size_t const Bytes) {
+    if (IsTrackingFootprint()) {
+        TopList & List = Active->Largest[Which];
+        auto const Entry = std::make_pair(Bytes, Name);
+        // the list is kept in descending order.
+        auto const It = std::upper_bound(List.begin(), List.end(), Entry,
+            std::greater<TopList::value_type>());
+        if (List.end() == It && LargestCount <= List.size())
+            return;
+        List.insert(It, Entry);
+        if (LargestCount < List.size())
+            List.pop_back();
+    }
+}
+
+void Statistics::Checkpoint() {
+    if (IsTrackingFootprint()) {
+        std::size_t Total = 0;
+        for (unsigned It = 0; It < FootprintCount; ++It) {
+            Total += Active->Current[It];
+        }
+        Active->PeakTotal = std::max(Active->PeakTotal, Total);
+    }
+}
+
+std::vector<Cost> const & Statistics::GetCosts(CostKind const Which) const {
+    return Costs[Which];
+}
+
+std::uint64_t Statistics::Get(Counter const Which) const {
+    return Counters[Which];
+}
+
+char const * Statistics::GetName(Counter const Which) {
+    return CounterNames[Which];
+}
+
+bool Statistics::FindCounter(llvm::StringRef const Name, Counter & Out) {
+    for (unsigned It = 0; It < CounterCount; ++It) {
+        if (Name == CounterNames[It]) {
+            Out = static_cast<Counter>(It);
+            return true;
+        }
+    }
+    return false;
+}
+
+void Statistics::Print(llvm::raw_ostream & OS) const {
+    OS << "===" << std::string(73, '-') << "===\n"
+       << "                      ... Constantine Statistics Collected ...\n"
+       << "===" << std::string(73, '-') << "===\n\n";
+    for (unsigned It = 0; It < CounterCount; ++It) {
+        OS << llvm::format("%8llu", static_cast<unsigned long long>(Counters[It]))
+           << " " << CounterNames[It] << " - " << CounterDescriptions[It] << '\n';
+    }
+    OS << '\n';
+    OS.flush();
+}
+
+void Statistics::PrintFootprint(llvm::raw_ostream & OS) const {
+    OS << "\n*** Constantine Memory Footprint:\n";
+    for (unsigned It = 0; It < FootprintCount; ++It) {
+        OS << "  " << FootprintDescriptions[It] << ": "
+           << Peak[It] << " bytes at peak\n";
+    }
+    OS << "  Total: " << PeakTotal << " bytes at peak\n";
+    for (unsigned It = 0; It < FootprintCount; ++It) {
+        if (LargestDescriptions[It] && (! Largest[It].empty())) {
+            OS << "  " << LargestDescriptions[It] << ":\n";
+            for (auto && Entry : Largest[It]) {
+                OS << llvm::format("%10llu", static_cast<unsigned long long>(Entry.first))
+                   << " bytes  " << Entry.second << '\n';
+            }
+        }
+    }
+    OS.flush();
+}
+
+
+Statistics::Activate::Activate(Statistics & Current)
+    : Previous(Active)
+{
+    Active = &Current;
+}
+
+Statistics::Activate::~Activate() {
+    Active = Previous;
+}
+
+
+Statistics::PhaseTimer::PhaseTimer(Phase const P)
+    : Owner((Active && Active->Group) ? Active : nullptr)
+    , Which(P)
+{
+    if (Owner && (0 == Owner->Depth[Which]++)) {
+        Owner->Timers[Which]->startTimer();
+    }
+}
+
+Statistics::PhaseTimer::~PhaseTimer() {
+    if (Owner && (0 == --Owner->Depth[Which])) {
+        Owner->Timers[Which]->stopTimer();
+    }
+}
+
+
+Statistics::CostScope::CostScope(CostKind const Kind, clang::NamedDecl const * const D)
+    : Owner((Active && Active->TopCosts) ? Active : nullptr)
+    , Which(Kind)
+    , Decl(D)
+    , Start(Owner ? llvm::TimeRecord::getCurrentTime(true) : llvm::TimeRecord())
+    , StartNodes(CountNodes())
+{ }
+
+Statistics::CostScope::~CostScope() {
+    if (! Owner)
+        return;
+
+    llvm::TimeRecord Elapsed = llvm::TimeRecord::getCurrentTime(false);
+    Elapsed -= Start;
+    Cost const Entry = { Decl, Elapsed.getWallTime(), CountNodes() - StartNodes };
+    // the list is kept in descending order.
+    std::vector<Cost> & List = Owner->Costs[Which];
+    auto const It = std::upper_bound(List.begin(), List.end(), Entry,
+        [](Cost const & Lhs, Cost const & Rhs) { return Lhs.Seconds > Rhs.Seconds; });
+    if (List.end() == It && Owner->TopCosts <= List.size())
+        return;
+    List.insert(It, Entry);
+    if (Owner->TopCosts < List.size())
+        List.pop_back();
+}
+
+std::uint64_t Statistics::CostScope::CountNodes() const {
+    std::uint64_t Result = 0;
+    if (Owner) {
+        for (auto const It : CostCounters[Which]) {
+            Result += Owner->Counters[It];
+        }
+    }
+    return Result;
+}
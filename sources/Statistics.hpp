@@ -0,0 +1,208 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/Timer.h>
+#include <llvm/Support/raw_ostream.h>
+
+namespace clang {
+    class NamedDecl;
+}
+
+// Phases of the analysis, each one has its own timer.
+enum Phase
+    { TraversalPhase
+    , ScopeAnalysisPhase
+    , DeclarationCollectorPhase
+    , AliasWalkPhase
+    , ReportingPhase
+    , PhaseCount
+    };
+
+// Counters of the analysis work. (Like llvm::Statistic, but owned by the
+// translation unit analysis instead of being process global.) These are
+// deterministic: the same input gives the same numbers.
+enum Counter
+    { FunctionsAnalysed
+    , NodesVisited
+    , RegisterCalls
+    , CandidatesInserted
+    , CandidatesErased
+    , ChangeNodesVisited
+    , AccessNodesVisited
+    , UsageNodesVisited
+    , ThisSearchNodesVisited
+    , UsageEntries
+    , RecordsWalked
+    , DeclarationsInserted
+    , AliasSteps
+    , RefereeSteps
+    , FindingsSuppressed
+    , InstantiationsSkipped
+    , CounterCount
+    };
+
+// Data structures of the analysis, which memory footprint is tracked.
+enum Footprint
+    { UsageMapsFootprint
+    , CandidateSetsFootprint
+    , RecordSummariesFootprint
+    , FootprintCount
+    };
+
+// Units of the analysis, which cost is measured.
+enum CostKind
+    { FunctionCost
+    , RecordSummaryCost
+    , CostKindCount
+    };
+
+// The measured cost of a function analysis or a record summary build.
+struct Cost {
+    clang::NamedDecl const * Decl;
+    double Seconds;
+    std::uint64_t Nodes;
+};
+
+// Estimated heap bytes of the node based standard containers. Every element
+// is allocated together with the tree (color, parent, left, right) or list
+// (next, previous) links. The allocator overhead is not counted.
+std::size_t const TreeNodeOverhead = 4 * sizeof(void *);
+std::size_t const ListNodeOverhead = 2 * sizeof(void *);
+
+template <typename T, typename C, typename A>
+std::size_t EstimateFootprint(std::set<T, C, A> const & S) {
+    return S.size() * (sizeof(T) + TreeNodeOverhead);
+}
+
+// Collects the timers and counters of one translation unit analysis.
+//
+// The analysis functions reach the active instance through a thread local
+// pointer, therefore compiler instances on different threads do not share
+// anything. When there is no active instance, counting does nothing.
+class Statistics {
+public:
+    // The timers are printed (into the '-ftime-report' output) when the
+    // instance goes away.
+    explicit Statistics(bool WithTimers, bool WithFootprint = false, unsigned TopCosts = 0);
+
+    static void Count(Counter, std::uint64_t = 1);
+
+    // The footprint accounting is done only when it was requested, because
+    // computing the sizes is not free. Callers shall check this first.
+    static bool IsTrackingFootprint();
+    // Set the current size of a data structure kind.
+    static void SetFootprint(Footprint, std::size_t Bytes);
+    // Attribute the size of a data structure to a function or a record.
+    // (Only the largest ones are kept.)
+    static void Attribute(Footprint, std::string const & Name, std::size_t Bytes);
+    // Update the peak values with the current sizes.
+    static void Checkpoint();
+
+    std::uint64_t Get(Counter) const;
+    void Print(llvm::raw_ostream &) const;
+    void PrintFootprint(llvm::raw_ostream &) const;
+    // The most expensive units in descending order.
+    std::vector<Cost> const & GetCosts(CostKind) const;
+
+    // The short name of the counters. (Used by the work budget argument.)
+    static char const * GetName(Counter);
+    static bool FindCounter(llvm::StringRef, Counter &);
+
+    Statistics(Statistics const &) = delete;
+    Statistics & operator=(Statistics const &) = delete;
+
+public:
+    // While alive the given instance is the active one on this thread.
+    class Activate {
+    public:
+        explicit Activate(Statistics &);
+        ~Activate();
+
+        Activate(Activate const &) = delete;
+        Activate & operator=(Activate const &) = delete;
+
+    private:
+        Statistics * const Previous;
+    };
+
+    // While alive the time is measured for the given phase of the active
+    // instance. Nested measure of the same phase is counted once.
+    class PhaseTimer {
+    public:
+        explicit PhaseTimer(Phase);
+        ~PhaseTimer();
+
+        PhaseTimer(PhaseTimer const &) = delete;
+        PhaseTimer & operator=(PhaseTimer const &) = delete;
+
+    private:
+        Statistics * const Owner;
+        Phase const Which;
+    };
+
+    // While alive the time and the visited nodes are measured for the given
+    // function or record. Does nothing unless the top costs were requested.
+    class CostScope {
+    public:
+        CostScope(CostKind, clang::NamedDecl const *);
+        ~CostScope();
+
+        CostScope(CostScope const &) = delete;
+        CostScope & operator=(CostScope const &) = delete;
+
+    private:
+        std::uint64_t CountNodes() const;
+
+    private:
+        Statistics * const Owner;
+        CostKind const Which;
+        clang::NamedDecl const * const Decl;
+        llvm::TimeRecord const Start;
+        std::uint64_t const StartNodes;
+    };
+
+private:
+    typedef std::vector<std::pair<std::size_t, std::string>> TopList;
+
+    std::unique_ptr<llvm::TimerGroup> Group;
+    std::unique_ptr<llvm::Timer> Timers[PhaseCount];
+    unsigned Depth[PhaseCount];
+    std::uint64_t Counters[CounterCount];
+
+    bool const WithFootprint;
+    std::size_t Current[FootprintCount];
+    std::size_t Peak[FootprintCount];
+    std::size_t PeakTotal;
+    TopList Largest[FootprintCount];
+
+    unsigned const TopCosts;
+    std::vector<Cost> Costs[CostKindCount];
+};
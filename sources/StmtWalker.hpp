@@ -0,0 +1,120 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+
+#include <clang/AST/AST.h>
+#include <llvm/ADT/SmallVector.h>
+
+
+// Pre-order walk of a statement tree with an explicit stack, instead of
+// the recursion of the RecursiveASTVisitor. (Long operator chains and
+// deeply nested expressions of generated code would need as deep native
+// stack as the tree is.)
+//
+// Only those nodes are walked here, which children are the same as the
+// RecursiveASTVisitor would traverse. Any other node (and its subtree) is
+// given to the TraverseStmt method of the visitor. Every walked node is
+// given to the VisitNode method of the visitor, which dispatches to its
+// Visit methods. The walk stops when that returns false.
+class StmtWalker {
+public:
+    template <typename Visitor>
+    static bool Walk(Visitor & V, clang::Stmt const * const Root) {
+        llvm::SmallVector<clang::Stmt const *, 32> Stack;
+        Stack.push_back(Root);
+        while (! Stack.empty()) {
+            clang::Stmt const * const Current = Stack.pop_back_val();
+            if (! Current)
+                continue;
+
+            if (! IsWalkable(Current)) {
+                if (! V.TraverseStmt(const_cast<clang::Stmt *>(Current)))
+                    return false;
+                continue;
+            }
+            if (! V.VisitNode(Current))
+                return false;
+            // the children are pushed backwards to visit them in order.
+            std::size_t const Size = Stack.size();
+            for (auto && Child : const_cast<clang::Stmt *>(Current)->children()) {
+                Stack.push_back(Child);
+            }
+            std::reverse(Stack.begin() + Size, Stack.end());
+        }
+        return true;
+    }
+
+private:
+    static bool IsWalkable(clang::Stmt const * const S) {
+        switch (S->getStmtClass()) {
+        case clang::Stmt::BinaryOperatorClass:
+        case clang::Stmt::CompoundAssignOperatorClass:
+        case clang::Stmt::UnaryOperatorClass:
+        case clang::Stmt::ConditionalOperatorClass:
+        case clang::Stmt::ParenExprClass:
+        case clang::Stmt::ImplicitCastExprClass:
+        case clang::Stmt::ArraySubscriptExprClass:
+        case clang::Stmt::CallExprClass:
+        case clang::Stmt::CXXMemberCallExprClass:
+        case clang::Stmt::CXXOperatorCallExprClass:
+        case clang::Stmt::CXXConstructExprClass:
+        case clang::Stmt::MaterializeTemporaryExprClass:
+        case clang::Stmt::ExprWithCleanupsClass:
+        case clang::Stmt::CXXBindTemporaryExprClass:
+        case clang::Stmt::IntegerLiteralClass:
+        case clang::Stmt::FloatingLiteralClass:
+        case clang::Stmt::CharacterLiteralClass:
+        case clang::Stmt::StringLiteralClass:
+        case clang::Stmt::CXXBoolLiteralExprClass:
+        case clang::Stmt::CXXNullPtrLiteralExprClass:
+        case clang::Stmt::CXXThisExprClass:
+        case clang::Stmt::CompoundStmtClass:
+        case clang::Stmt::ReturnStmtClass:
+        case clang::Stmt::NullStmtClass:
+        case clang::Stmt::BreakStmtClass:
+        case clang::Stmt::ContinueStmtClass:
+        case clang::Stmt::DoStmtClass:
+            return true;
+        // the visitor traverses the name qualifier and the template
+        // arguments too, which might contain expressions.
+        case clang::Stmt::DeclRefExprClass: {
+            auto const E = clang::cast<clang::DeclRefExpr const>(S);
+            return (! E->hasQualifier()) && (! E->hasExplicitTemplateArgs());
+        }
+        case clang::Stmt::MemberExprClass: {
+            auto const E = clang::cast<clang::MemberExpr const>(S);
+            return (! E->hasQualifier()) && (! E->hasExplicitTemplateArgs());
+        }
+        // the visitor traverses the condition variable declaration.
+        case clang::Stmt::IfStmtClass:
+            return nullptr == clang::cast<clang::IfStmt const>(S)->getConditionVariable();
+        case clang::Stmt::WhileStmtClass:
+            return nullptr == clang::cast<clang::WhileStmt const>(S)->getConditionVariable();
+        case clang::Stmt::ForStmtClass:
+            return nullptr == clang::cast<clang::ForStmt const>(S)->getConditionVariable();
+        default:
+            return false;
+        }
+    }
+};
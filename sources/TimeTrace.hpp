@@ -0,0 +1,57 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include <string>
+
+#include <llvm/Config/llvm-config.h>
+#if LLVM_VERSION_MAJOR >= 9
+#include <llvm/Support/TimeProfiler.h>
+#endif
+
+// Marks a section in the '-ftime-trace' output of the compiler. The detail
+// (function or class name) is computed only when the trace is recorded.
+//
+// The time trace profiler was introduced in LLVM 9, this does nothing when
+// it's compiled against earlier versions. (Which are the only supported
+// ones at the moment, the scopes are placeholders until the port.)
+class TraceScope {
+public:
+    template <typename Detail>
+    TraceScope(char const * const Name, Detail && Describe)
+#if LLVM_VERSION_MAJOR >= 9
+        : Scope(Name, Describe)
+    { }
+#else
+    {
+        (void)Name;
+        (void)Describe;
+    }
+#endif
+
+    TraceScope(TraceScope const &) = delete;
+    TraceScope & operator=(TraceScope const &) = delete;
+
+#if LLVM_VERSION_MAJOR >= 9
+private:
+    llvm::TimeTraceScope Scope;
+#endif
+};
@@ -0,0 +1,14 @@
+// RUN: %clang_verify -I %S/Inputs -Xclang -plugin-arg-constantine -Xclang -analysis-level=thorough %s
+// expected-no-diagnostics
+
+// The field is changed only by the instantiation of a header template.
+
+#include "HeaderTemplates.hpp"
+
+struct Tally {
+    int count;
+};
+
+void touch(Tally & t) {
+    bump(t);
+}
@@ -0,0 +1,8 @@
+#pragma once
+
+// The body of the template is parsed even when the other bodies of the
+// header are skipped.
+template <typename T>
+void bump(T & t) {
+    ++t.count;
+}
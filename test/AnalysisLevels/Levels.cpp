@@ -0,0 +1,49 @@
+// RUN: %clang_verify -DFAST -Xclang -plugin-arg-constantine -Xclang -analysis-level=fast %s
+// RUN: %clang_verify -DDEFAULT %s
+// RUN: %clang_verify -DDEFAULT -Xclang -plugin-arg-constantine -Xclang -analysis-level=default %s
+// RUN: %clang_verify -DTHOROUGH -Xclang -plugin-arg-constantine -Xclang -analysis-level=thorough %s
+
+// Locals and parameters are checked on every level.
+int twice(int a) { // expected-warning {{variable 'a' could be declared as const}}
+    return a * 2;
+}
+
+// Changes through references are tracked from the default level.
+void through_reference() {
+    int i = 0;
+#ifdef FAST
+    // expected-warning@-2 {{variable 'i' could be declared as const}}
+#endif
+    int & k = i;
+    ++k;
+}
+
+// Fields and methods are checked from the default level.
+struct Point {
+    int x;
+#ifdef DEFAULT
+    // expected-warning@-2 {{variable 'x' could be declared as const}}
+#endif
+    int y;
+#ifndef FAST
+    // expected-warning@-2 {{variable 'y' could be declared as const}}
+#endif
+
+    int get_x() {
+#ifndef FAST
+    // expected-warning@-2 {{function 'get_x' could be declared as const}}
+#endif
+        return x;
+    }
+    int get_y() {
+#ifndef FAST
+    // expected-warning@-2 {{function 'get_y' could be declared as const}}
+#endif
+        return y;
+    }
+};
+
+// Changes of fields from free functions are tracked on the thorough level.
+void shift(Point & p) {
+    p.x += 1;
+}
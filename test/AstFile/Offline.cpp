@@ -0,0 +1,21 @@
+// RUN: %clang_emit_ast -o %t.ast %s
+// RUN: %constantine_ast %t.ast 2>&1 | grep "variable 'i' could be declared as const"
+// RUN: %constantine_ast -j 2 %t.ast %t.ast 2>&1 | grep -c "function 'get' could be declared as const" | grep 2
+// RUN: %constantine_ast -debug-constantine=VariableChanges %t.ast 2>&1 | grep "variable 'j' with type 'int' was changed"
+
+struct Value {
+    int get();
+
+    int m_value;
+};
+
+int Value::get() {
+    return m_value;
+}
+
+int test(int a) {
+    int i = a;
+    int j = 0;
+    j += i;
+    return j;
+}
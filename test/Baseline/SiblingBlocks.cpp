@@ -0,0 +1,28 @@
+// RUN: rm -f %t.jsonl %t.baseline
+// RUN: %clang_verify -DFIRST_RUN -Xclang -plugin-arg-constantine -Xclang -output=%t.jsonl %s
+// RUN: %constantine_baseline --output %t.baseline %t.jsonl
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -baseline=%t.baseline %s
+
+// The same named locals of sibling blocks have different fingerprints, the
+// baselined one does not hide the new one.
+
+void consume(int);
+
+void blocks() {
+    {
+        int x = 0;
+#ifdef FIRST_RUN
+        // expected-warning@-2 {{variable 'x' could be declared as const}}
+#endif
+        consume(x);
+    }
+    {
+        int x = 0;
+#ifdef FIRST_RUN
+        ++x;
+#else
+        // expected-warning@-4 {{variable 'x' could be declared as const}}
+#endif
+        consume(x);
+    }
+}
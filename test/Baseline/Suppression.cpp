@@ -0,0 +1,29 @@
+// RUN: rm -f %t.jsonl %t.baseline
+// RUN: %clang_verify -DFIRST_RUN -Xclang -plugin-arg-constantine -Xclang -output=%t.jsonl %s
+// RUN: %constantine_baseline --output %t.baseline %t.jsonl
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -baseline=%t.baseline %s
+
+int accepted(int k) {
+#ifdef FIRST_RUN
+    // expected-warning@-2 {{variable 'k' could be declared as const}}
+#endif
+    return k;
+}
+
+struct Counter {
+    int count() {
+#ifdef FIRST_RUN
+    // expected-warning@-2 {{function 'count' could be declared as const}}
+#endif
+        return m_count;
+    }
+    void increment() {
+        ++m_count;
+    }
+
+    int m_count;
+};
+
+int fresh(int n) { // expected-warning {{variable 'n' could be declared as const}}
+    return n;
+}
@@ -0,0 +1,59 @@
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -analysis-level=thorough %s
+// RUN: %clang_verify -DPATTERN %s
+
+// On the thorough level the by value parameters of the templates are
+// checked against the instantiations: a parameter which is never changed,
+// but copied as a large or non-trivially copyable type, is reported with
+// the copying instantiations.
+
+struct Small {
+    int size() const;
+};
+
+struct Block {
+    int size() const;
+
+    long data[8];
+};
+
+struct Text {
+    Text(Text const &);
+
+    int size() const;
+    int take();
+};
+
+template <typename T>
+int measure(T value) { // expected-warning {{variable 'value' could be declared as const}}
+#ifndef PATTERN
+    // expected-warning@-2 {{parameter 'value' is copied, it could be passed by const reference}}
+#endif
+    return value.size();
+}
+
+template <typename T>
+int drain(T value) {
+#ifdef PATTERN
+    // expected-warning@-2 {{variable 'value' could be declared as const}}
+#endif
+    return value.take();
+}
+
+template <typename T>
+int peek(T const & value) {
+    return value.size();
+}
+
+int use(Text const & t, Block const & b, Small const & s) {
+    return measure(t)
+#ifndef PATTERN
+    // expected-note@-2 {{copied as 'Text' by the instantiation 'measure<Text>'}}
+#endif
+        + measure(b)
+#ifndef PATTERN
+    // expected-note@-2 {{copied as 'Block' by the instantiation 'measure<Block>'}}
+#endif
+        + measure(s)
+        + drain(t)
+        + peek(t);
+}
@@ -0,0 +1,36 @@
+// RUN: rm -f %t.jsonl
+// RUN: %clang_verify -DALL -Xclang -plugin-arg-constantine -Xclang -impact-order -Xclang -plugin-arg-constantine -Xclang -output=%t.jsonl %s
+// RUN: sed -n 1p %t.jsonl | grep '"name":"b",.*"impact":{"score":4096,"bytes":256,"copies":true,"loop-depth":0}'
+// RUN: sed -n 2p %t.jsonl | grep '"name":"n",.*"impact":{"score":400,"bytes":4,"copies":false,"loop-depth":2}'
+// RUN: sed -n 3p %t.jsonl | grep '"name":"k",.*"impact":{"score":4,"bytes":4,"copies":false,"loop-depth":0}'
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -min-impact=10 %s
+
+int small(int k) {
+#ifdef ALL
+    // expected-warning@-2 {{variable 'k' could be declared as const}}
+#endif
+    return k;
+}
+
+int nested(int n) { // expected-warning {{variable 'n' could be declared as const}}
+    int sum = 0;
+    for (int i = 0; i < 8; ++i) {
+        for (int j = 0; j < n; ++j) {
+            sum += i * j;
+        }
+    }
+    return sum;
+}
+
+struct Big {
+    Big();
+    Big(Big const &);
+
+    int value() const;
+
+    int data[64];
+};
+
+int copied(Big b) { // expected-warning {{variable 'b' could be declared as const}}
+    return b.value();
+}
@@ -0,0 +1,158 @@
+/*  Copyright (C) 2012-2014  László Nagy
+    This file is part of Constantine.
+
+    Constantine implements pseudo const analysis.
+
+    Constantine is free software: you can redistribute it and/or modify
+    it under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License, or
+    (at your option) any later version.
+
+    Constantine is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty of
+    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+    GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "Constantine.hpp"
+
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <llvm/ADT/StringRef.h>
+#include <llvm/Support/MemoryBuffer.h>
+#include <llvm/Support/raw_ostream.h>
+#include <clang/AST/RecursiveASTVisitor.h>
+#include <clang/Frontend/ASTUnit.h>
+#include <clang/Tooling/Tooling.h>
+
+
+// Test driver of the library interface. It parses the given file, runs
+// the analysis through the library entry points, and prints the verdicts
+// and the facts line by line, for the lit tests to grep.
+//
+// Without function names the whole translation unit is analysed, with
+// names only the definitions with those qualified names. The analysis
+// level is given by the optional '-level=fast|default|thorough' argument.
+
+namespace {
+
+static char const * const tool_name = "constantine-library";
+
+// Collects the function definitions by qualified name.
+class FunctionFinder
+    : public clang::RecursiveASTVisitor<FunctionFinder> {
+public:
+    FunctionFinder(std::set<std::string> const & Names, std::vector<clang::FunctionDecl const *> & Out)
+        : clang::RecursiveASTVisitor<FunctionFinder>()
+        , Wanted(Names)
+        , Results(Out)
+    { }
+
+    bool VisitFunctionDecl(clang::FunctionDecl const * const F) {
+        if (F->isThisDeclarationADefinition() && (Wanted.end() != Wanted.find(F->getQualifiedNameAsString()))) {
+            Results.push_back(F);
+        }
+        return true;
+    }
+
+private:
+    std::set<std::string> const & Wanted;
+    std::vector<clang::FunctionDecl const *> & Results;
+};
+
+// Variables of functions are printed with their function, fields and
+// methods with their qualified name.
+std::string GetName(clang::DeclaratorDecl const * const D) {
+    if (auto const F = clang::dyn_cast_or_null<clang::FunctionDecl const>(D->getParentFunctionOrMethod())) {
+        return D->getNameAsString() + " in " + F->getQualifiedNameAsString();
+    }
+    return D->getQualifiedNameAsString();
+}
+
+// The names of the map in alphabetical order, comma separated.
+std::string JoinNames(UsageRefsMap const & Facts) {
+    std::vector<std::string> Names;
+    for (auto && Entry : Facts) {
+        Names.push_back(Entry.first->getNameAsString());
+    }
+    std::sort(Names.begin(), Names.end());
+    std::string Result;
+    for (auto && Name : Names) {
+        Result += (Result.empty() ? "" : ",") + Name;
+    }
+    return Result;
+}
+
+void Print(llvm::raw_ostream & OS, AnalysisResults const & Results) {
+    for (auto && Variable : Results.ConstVariables) {
+        OS << "const-variable " << GetName(Variable) << '\n';
+    }
+    for (auto && Method : Results.ConstMethods) {
+        OS << "const-method " << GetName(Method) << '\n';
+    }
+    for (auto && Method : Results.StaticMethods) {
+        OS << "static-method " << GetName(Method) << '\n';
+    }
+    for (auto && Parameter : Results.ByValueParameters) {
+        OS << "by-value-parameter " << GetName(Parameter) << '\n';
+    }
+    for (auto && Entry : Results.Facts) {
+        OS << "facts " << Entry.Function->getQualifiedNameAsString()
+           << " changed=" << JoinNames(Entry.Changed)
+           << " used=" << JoinNames(Entry.Used) << '\n';
+    }
+}
+
+} // namespace anonymous
+
+
+int main(int argc, char const * argv[]) {
+    AnalysisLevel Level = DefaultLevel;
+    if ((argc > 1) && llvm::StringRef(argv[1]).startswith("-level=")) {
+        llvm::StringRef const Value = llvm::StringRef(argv[1]).substr(7);
+        if (Value == "fast") {
+            Level = FastLevel;
+        } else if (Value == "thorough") {
+            Level = ThoroughLevel;
+        } else if (Value != "default") {
+            llvm::errs() << tool_name << ": unknown level '" << Value << "'\n";
+            return 1;
+        }
+        --argc;
+        ++argv;
+    }
+    if (argc < 2) {
+        llvm::errs() << "usage: " << tool_name << " [-level=<level>] <file> [function...]\n";
+        return 1;
+    }
+    auto const Input = llvm::MemoryBuffer::getFile(argv[1]);
+    if (! Input) {
+        llvm::errs() << tool_name << ": cannot read '" << argv[1] << "'\n";
+        return 1;
+    }
+    std::unique_ptr<clang::ASTUnit> const Unit =
+        clang::tooling::buildASTFromCodeWithArgs(Input.get()->getBuffer(), { "-std=c++11" }, "input.cpp");
+    if ((! Unit) || Unit->getDiagnostics().hasErrorOccurred()) {
+        llvm::errs() << tool_name << ": cannot parse '" << argv[1] << "'\n";
+        return 1;
+    }
+    clang::ASTContext & Ctx = Unit->getASTContext();
+    if (argc == 2) {
+        Print(llvm::outs(), AnalyseTranslationUnit(Ctx, true, Level));
+        return 0;
+    }
+    std::set<std::string> const Names(argv + 2, argv + argc);
+    std::vector<clang::FunctionDecl const *> Functions;
+    FunctionFinder Finder(Names, Functions);
+    Finder.TraverseDecl(Ctx.getTranslationUnitDecl());
+    Print(llvm::outs(), AnalyseFunctions(Functions, true, Level));
+    return 0;
+}
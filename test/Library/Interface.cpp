@@ -0,0 +1,42 @@
+// RUN: %constantine_library %s > %t.unit
+// RUN: grep -x 'const-variable k in get' %t.unit
+// RUN: grep -x 'const-method Counter::count' %t.unit
+// RUN: grep -x 'static-method Counter::size' %t.unit
+// RUN: grep -x 'facts get changed= used=k' %t.unit
+// RUN: grep -x 'facts Counter::count changed= used=m_count' %t.unit
+// RUN: grep -x 'facts Counter::increment changed=m_count used=m_count' %t.unit
+// RUN: grep -c '^facts ' %t.unit | grep '^4$'
+// RUN: sed -n '/m_count$/p' %t.unit | sed -n '/^const-variable/p' | wc -l | grep '^ *0$'
+// RUN: %constantine_library %s Counter::count Counter::size > %t.functions
+// RUN: grep -x 'const-variable Counter::m_count' %t.functions
+// RUN: grep -x 'const-method Counter::count' %t.functions
+// RUN: grep -x 'static-method Counter::size' %t.functions
+// RUN: grep -x 'facts Counter::count changed= used=m_count' %t.functions
+// RUN: grep -x 'facts Counter::size changed= used=' %t.functions
+// RUN: grep -c '^facts ' %t.functions | grep '^2$'
+// RUN: %constantine_library -level=fast %s > %t.fast
+// RUN: grep -x 'const-variable k in get' %t.fast
+// RUN: sed -n '/^const-method/p' %t.fast | wc -l | grep '^ *0$'
+// RUN: grep -c '^facts ' %t.fast | grep '^4$'
+
+// The library entry points: the whole translation unit, and the given
+// functions only. (Without 'increment' the field is not changed.) The
+// fast level checks only the locals and the parameters.
+
+int get(int k) {
+    return k;
+}
+
+struct Counter {
+    int count() {
+        return m_count;
+    }
+    int size() {
+        return 0;
+    }
+    void increment() {
+        ++m_count;
+    }
+
+    int m_count;
+};
@@ -0,0 +1,20 @@
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -debug-constantine=FuncionDeclaration,VariableChanges,PseudoConstness %s
+
+int get(int k) { // expected-note {{function 'get' declared here}}
+                 // expected-warning@-1 {{variable 'k' could be declared as const}}
+    int i = 0;
+    i = k; // expected-note {{variable 'i' with type 'int' was changed}}
+    return i;
+}
+
+struct Counter {
+    void increment() { // expected-note {{function 'increment' declared here}}
+        ++m_count; // expected-note {{variable 'm_count' with type 'int' was changed}}
+    }
+    int count() { // expected-note {{function 'count' declared here}}
+                  // expected-warning@-1 {{function 'count' could be declared as const}}
+        return m_count;
+    }
+
+    int m_count;
+};
@@ -0,0 +1,65 @@
+// REQUIRES: llvm-profdata
+// RUN: printf '_Z3hoti\n1\n1\n5000\n\n_Z4coldi\n1\n1\n2\n\n_ZN7Counter5countEv\n1\n1\n300\n\n_Z6scaledIiEiT_\n1\n1\n400\n\n_Z6scaledIlEiT_\n1\n1\n300\n\n_ZN5GaugeIiE4readEv\n1\n1\n50\n' > %t.proftext
+// RUN: %llvm_profdata merge -o %t.profdata %t.proftext
+// RUN: %clang_verify -DALL -Xclang -plugin-arg-constantine -Xclang -profile=%t.profdata %s
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -profile=%t.profdata -Xclang -plugin-arg-constantine -Xclang -min-entry-count=100 %s
+
+int hot(int k) { // expected-warning {{variable 'k' could be declared as const}} expected-note {{the function was entered 5000 times according to the profile}}
+    return k;
+}
+
+int cold(int k) {
+#ifdef ALL
+    // expected-warning@-2 {{variable 'k' could be declared as const}}
+    // expected-note@-3 {{the function was entered 2 times according to the profile}}
+#endif
+    return k;
+}
+
+// not in the profile, never reported with entry count limit.
+int unknown(int k) {
+#ifdef ALL
+    // expected-warning@-2 {{variable 'k' could be declared as const}}
+#endif
+    return k;
+}
+
+struct Counter {
+    int count() { // expected-warning {{function 'count' could be declared as const}} expected-note {{the function was entered 300 times according to the profile}}
+        return m_count;
+    }
+    void increment() {
+        ++m_count;
+    }
+
+    int m_count;
+};
+
+// the templates have the sum of their instantiations.
+template <typename T>
+int scaled(T k) { // expected-warning {{variable 'k' could be declared as const}} expected-note {{the function was entered 700 times according to the profile}}
+    return k * 2;
+}
+
+int use_scaled() {
+    return scaled(1) + scaled(2L);
+}
+
+template <typename T>
+struct Gauge {
+    T level;
+#ifdef ALL
+    // expected-warning@-2 {{variable 'level' could be declared as const}}
+#endif
+    int read() {
+#ifdef ALL
+    // expected-warning@-2 {{function 'read' could be declared as const}}
+    // expected-note@-3 {{the function was entered 50 times according to the profile}}
+#endif
+        return level;
+    }
+};
+
+int use_gauge(Gauge<int> & g) {
+    return g.read();
+}
@@ -0,0 +1,33 @@
+// REQUIRES: llvm-profdata
+// RUN: rm -f %t.jsonl
+// RUN: printf '_Z3hot3Bigi\n1\n1\n1000000000000000\n' > %t.proftext
+// RUN: %llvm_profdata merge -o %t.profdata %t.proftext
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -profile=%t.profdata -Xclang -plugin-arg-constantine -Xclang -impact-order -Xclang -plugin-arg-constantine -Xclang -output=%t.jsonl %s
+// RUN: sed -n 1p %t.jsonl | grep '"name":"b",.*"impact":{"score":18446744073709551615,'
+// RUN: sed -n 2p %t.jsonl | grep '"name":"n",.*"impact":{"score":4000000000000000000,'
+// RUN: sed -n 3p %t.jsonl | grep '"name":"k",.*"impact":{"score":4,'
+
+// The score of a big copy in a deep loop of a hot function does not fit
+// into 64 bits, it saturates instead of wrapping around.
+
+struct Big {
+    Big();
+    Big(Big const &);
+
+    int value() const;
+
+    char data[4096];
+};
+
+int hot(Big b, int n) { // expected-warning {{variable 'b' could be declared as const}} expected-warning {{variable 'n' could be declared as const}} expected-note 2 {{the function was entered 1000000000000000 times according to the profile}}
+    int sum = 0;
+    for (int i = 0; i < 2; ++i)
+        for (int j = 0; j < 2; ++j)
+            for (int l = 0; l < n; ++l)
+                sum += b.value();
+    return sum;
+}
+
+int cold(int k) { // expected-warning {{variable 'k' could be declared as const}}
+    return k;
+}
@@ -1,4 +1,5 @@
 // RUN: %clang_verify %s
+// RUN: %clang_verify %oracle %s
 
 struct Base {
     int const value;
@@ -1,4 +1,5 @@
 // RUN: %clang_verify %s
+// RUN: %clang_verify %oracle %s
 // expected-no-diagnostics
 
 struct B {
@@ -0,0 +1,14 @@
+#pragma once
+
+// The body is not parsed in analysis only runs, so the undeclared
+// function does not make any error.
+inline int header_function(int a) {
+    int i = a;
+    return not_declared_anywhere(i);
+}
+
+struct HeaderType {
+    int get() { return m_value; }
+
+    int m_value;
+};
@@ -1,4 +1,5 @@
 // RUN: %clang_verify %s
+// RUN: %clang_verify %oracle %s
 
 void do_mutating_through_reference(bool const a) {
     int i = 0;
@@ -1,4 +1,5 @@
 // RUN: %clang_verify %s
+// RUN: %clang_verify %oracle %s
 
 void test_1() {
     int i = 0; // expected-warning {{variable 'i' could be declared as const}}
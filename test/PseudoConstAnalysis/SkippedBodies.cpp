@@ -0,0 +1,14 @@
+// RUN: %clang_verify -I %S/Inputs %s
+// RUN: %clang_verify %oracle -I %S/Inputs %s
+
+#include "HeaderBodies.hpp"
+
+int test_1(int a) {
+    int i = header_function(a); // expected-warning {{variable 'i' could be declared as const}}
+    return i;
+}
+
+int test_2() {
+    HeaderType t;
+    return t.get() + 1;
+}
@@ -0,0 +1,59 @@
+// RUN: %clang_verify -DPATTERN %s
+// RUN: %clang_verify -DPATTERN %oracle %s
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -analysis-level=thorough %s
+
+// On the thorough level the instantiations are analysed too, and the
+// findings of the template are reported only when every instantiation
+// agrees. (Without that, only the template pattern is analysed.)
+
+struct Fixed {
+    int get() const;
+};
+
+struct Mutable {
+    int get();
+};
+
+template <typename T>
+int twice(T value) { // expected-warning {{variable 'value' could be declared as const}}
+    return value.get() * 2;
+}
+
+template <typename T>
+int read(T value) {
+#ifdef PATTERN
+    // expected-warning@-2 {{variable 'value' could be declared as const}}
+#endif
+    return value.get();
+}
+
+template <typename T>
+struct Shelf {
+    T item; // expected-warning {{variable 'item' could be declared as const}}
+
+    int peek() { // expected-warning {{function 'peek' could be declared as const}}
+        return item.get();
+    }
+};
+
+template <typename T>
+struct Box {
+    T item;
+#ifdef PATTERN
+    // expected-warning@-2 {{variable 'item' could be declared as const}}
+#endif
+
+    int peek() {
+#ifdef PATTERN
+    // expected-warning@-2 {{function 'peek' could be declared as const}}
+#endif
+        return item.get();
+    }
+};
+
+int use(Fixed const & f, Mutable const & m) {
+    Shelf<Fixed> s;
+    Box<Fixed> a;
+    Box<Mutable> b;
+    return twice(f) + read(f) + read(m) + s.peek() + a.peek() + b.peek();
+}
@@ -0,0 +1,28 @@
+// RUN: rm -rf %t %t.miss %t.hit
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -cache-dir=%t -Xclang -plugin-arg-constantine -Xclang -print-stats %s 2> %t.miss
+// RUN: grep 'Constantine Statistics Collected' %t.miss
+// RUN: ls %t/*.constantine
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -cache-dir=%t -Xclang -plugin-arg-constantine -Xclang -print-stats %s 2> %t.hit
+// RUN: sed -n '/Constantine Statistics Collected/p' %t.hit | wc -l | grep '^ *0$'
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -cache-dir=%t %s
+
+// The first run is a miss: the analysis runs (and prints the counters),
+// the findings are stored. The next runs are replaying the stored
+// findings without running the analysis.
+
+struct Value {
+    int get();
+
+    int m_value;
+};
+
+int Value::get() { // expected-warning {{function 'get' could be declared as const}}
+    return m_value;
+}
+
+int test(int a) {
+    int i = a; // expected-warning {{variable 'i' could be declared as const}}
+    int j = 0;
+    j += i;
+    return j;
+}
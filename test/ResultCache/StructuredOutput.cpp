@@ -0,0 +1,24 @@
+// RUN: rm -rf %t %t.first.jsonl %t.second.jsonl %t.hit
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -cache-dir=%t -Xclang -plugin-arg-constantine -Xclang -output=%t.first.jsonl %s
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -cache-dir=%t -Xclang -plugin-arg-constantine -Xclang -output=%t.second.jsonl -Xclang -plugin-arg-constantine -Xclang -print-stats %s 2> %t.hit
+// RUN: sed -n '/Constantine Statistics Collected/p' %t.hit | wc -l | grep '^ *0$'
+// RUN: diff %t.first.jsonl %t.second.jsonl
+// RUN: grep -c '"kind":' %t.second.jsonl | grep '^2$'
+
+// The structured output is stored with the findings, and restored by the
+// cache hit.
+
+int get(int k) { // expected-warning {{variable 'k' could be declared as const}}
+    return k;
+}
+
+struct Counter {
+    int count() { // expected-warning {{function 'count' could be declared as const}}
+        return m_count;
+    }
+    void increment() {
+        ++m_count;
+    }
+
+    int m_count;
+};
@@ -0,0 +1,21 @@
+// RUN: rm -f %t.jsonl
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -output=%t.jsonl %s
+// RUN: grep '{"kind":"variable-const","name":"k","usr":"c:@F@get(int)@k",' %t.jsonl
+// RUN: grep '{"kind":"function-const","name":"count","usr":"c:@S@Counter@F@count()",' %t.jsonl
+// RUN: grep -c '"kind":' %t.jsonl | grep '^2$'
+// RUN: grep '"impact":{"score":4,"bytes":4,"copies":false}' %t.jsonl
+
+int get(int k) { // expected-warning {{variable 'k' could be declared as const}}
+    return k;
+}
+
+struct Counter {
+    int count() { // expected-warning {{function 'count' could be declared as const}}
+        return m_count;
+    }
+    void increment() {
+        ++m_count;
+    }
+
+    int m_count;
+};
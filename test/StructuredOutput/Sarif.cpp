@@ -0,0 +1,13 @@
+// RUN: rm -f %t.sarif
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -output=%t.sarif -Xclang -plugin-arg-constantine -Xclang -output-format=sarif -Xclang -plugin-arg-constantine -Xclang -no-text-output %s
+// RUN: grep '"version":"2.1.0"' %t.sarif
+// RUN: grep '{"ruleId":"variable-const","level":"warning","message":{"text":"variable .k. could be declared as const"}' %t.sarif
+// RUN: rm -rf %t.dir %t.encoded.sarif && mkdir -p '%t.dir/a b#c'
+// RUN: cp %s '%t.dir/a b#c/input.cpp'
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -output=%t.encoded.sarif -Xclang -plugin-arg-constantine -Xclang -output-format=sarif -Xclang -plugin-arg-constantine -Xclang -no-text-output '%t.dir/a b#c/input.cpp'
+// RUN: grep '"uri":"file:///.*/a%%20b%%23c/input.cpp"' %t.encoded.sarif
+// expected-no-diagnostics
+
+int get(int k) {
+    return k;
+}
@@ -0,0 +1,29 @@
+// RUN: rm -f %t.jsonl
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -output=%t.jsonl %s
+// RUN: sed -n 1p %t.jsonl | grep '"name":"first"'
+// RUN: sed -n 2p %t.jsonl | grep '"name":"count"'
+// RUN: sed -n 3p %t.jsonl | grep '"name":"size"'
+// RUN: sed -n 4p %t.jsonl | grep '"name":"last"'
+// RUN: grep -c '"kind":' %t.jsonl | grep '^4$'
+
+int before(int first) { // expected-warning {{variable 'first' could be declared as const}}
+    return first;
+}
+
+struct Counter {
+    int count() { // expected-warning {{function 'count' could be declared as const}}
+        return m_count;
+    }
+    int size() { // expected-warning {{function 'size' could be declared as static}}
+        return 0;
+    }
+    void increment() {
+        ++m_count;
+    }
+
+    int m_count;
+};
+
+int after(int last) { // expected-warning {{variable 'last' could be declared as const}}
+    return last;
+}
@@ -0,0 +1,12 @@
+// RUN: %clang_verify -Xclang -plugin-arg-constantine -Xclang -top-costs=3 %s
+
+struct Point { // expected-note-re {{record 'Point' took {{[0-9.]+}} ms to summarise, walked {{[0-9]+}} declarations}}
+    int get() const { return x; } // expected-note-re {{function 'Point::get' took {{[0-9.]+}} ms to analyse, visited {{[0-9]+}} nodes}}
+    void set(int const v) { x = v; } // expected-note-re {{function 'Point::set' took {{[0-9.]+}} ms to analyse, visited {{[0-9]+}} nodes}}
+
+    int x;
+};
+
+int twice(int const v) { // expected-note-re {{function 'twice' took {{[0-9.]+}} ms to analyse, visited {{[0-9]+}} nodes}}
+    return 2 * v;
+}
@@ -0,0 +1,217 @@
+// RUN: %clang_verify %budget=change-nodes:8000 %budget=module-nodes:8000 %s
+// RUN: %clang_verify %budget=usage-nodes:100 %budget=alias-steps:1000 %budget=referee-steps:1500 %s
+// expected-no-diagnostics
+
+// Long expression chains should be walked in linear work.
+
+int sum(int const a) {
+    int const r = a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a + a;
+    return r;
+}
+
+int select(bool const c) {
+    int x0 = 0;
+    int x1 = 0;
+    int x2 = 0;
+    int x3 = 0;
+    int x4 = 0;
+    int x5 = 0;
+    int x6 = 0;
+    int x7 = 0;
+    int x8 = 0;
+    int x9 = 0;
+    int x10 = 0;
+    int x11 = 0;
+    int x12 = 0;
+    int x13 = 0;
+    int x14 = 0;
+    int x15 = 0;
+    int x16 = 0;
+    int x17 = 0;
+    int x18 = 0;
+    int x19 = 0;
+    int x20 = 0;
+    int x21 = 0;
+    int x22 = 0;
+    int x23 = 0;
+    int x24 = 0;
+    int x25 = 0;
+    int x26 = 0;
+    int x27 = 0;
+    int x28 = 0;
+    int x29 = 0;
+    int x30 = 0;
+    int x31 = 0;
+    int x32 = 0;
+    int x33 = 0;
+    int x34 = 0;
+    int x35 = 0;
+    int x36 = 0;
+    int x37 = 0;
+    int x38 = 0;
+    int x39 = 0;
+    int x40 = 0;
+    int x41 = 0;
+    int x42 = 0;
+    int x43 = 0;
+    int x44 = 0;
+    int x45 = 0;
+    int x46 = 0;
+    int x47 = 0;
+    int x48 = 0;
+    int x49 = 0;
+    int x50 = 0;
+    int x51 = 0;
+    int x52 = 0;
+    int x53 = 0;
+    int x54 = 0;
+    int x55 = 0;
+    int x56 = 0;
+    int x57 = 0;
+    int x58 = 0;
+    int x59 = 0;
+    int x60 = 0;
+    int x61 = 0;
+    int x62 = 0;
+    int x63 = 0;
+    int x64 = 0;
+    int x65 = 0;
+    int x66 = 0;
+    int x67 = 0;
+    int x68 = 0;
+    int x69 = 0;
+    int x70 = 0;
+    int x71 = 0;
+    int x72 = 0;
+    int x73 = 0;
+    int x74 = 0;
+    int x75 = 0;
+    int x76 = 0;
+    int x77 = 0;
+    int x78 = 0;
+    int x79 = 0;
+    int x80 = 0;
+    int x81 = 0;
+    int x82 = 0;
+    int x83 = 0;
+    int x84 = 0;
+    int x85 = 0;
+    int x86 = 0;
+    int x87 = 0;
+    int x88 = 0;
+    int x89 = 0;
+    int x90 = 0;
+    int x91 = 0;
+    int x92 = 0;
+    int x93 = 0;
+    int x94 = 0;
+    int x95 = 0;
+    int x96 = 0;
+    int x97 = 0;
+    int x98 = 0;
+    int x99 = 0;
+    int x100 = 0;
+    int x101 = 0;
+    int x102 = 0;
+    int x103 = 0;
+    int x104 = 0;
+    int x105 = 0;
+    int x106 = 0;
+    int x107 = 0;
+    int x108 = 0;
+    int x109 = 0;
+    int x110 = 0;
+    int x111 = 0;
+    int x112 = 0;
+    int x113 = 0;
+    int x114 = 0;
+    int x115 = 0;
+    int x116 = 0;
+    int x117 = 0;
+    int x118 = 0;
+    int x119 = 0;
+    int x120 = 0;
+    int x121 = 0;
+    int x122 = 0;
+    int x123 = 0;
+    int x124 = 0;
+    int x125 = 0;
+    int x126 = 0;
+    int x127 = 0;
+    int x128 = 0;
+    int x129 = 0;
+    int x130 = 0;
+    int x131 = 0;
+    int x132 = 0;
+    int x133 = 0;
+    int x134 = 0;
+    int x135 = 0;
+    int x136 = 0;
+    int x137 = 0;
+    int x138 = 0;
+    int x139 = 0;
+    int x140 = 0;
+    int x141 = 0;
+    int x142 = 0;
+    int x143 = 0;
+    int x144 = 0;
+    int x145 = 0;
+    int x146 = 0;
+    int x147 = 0;
+    int x148 = 0;
+    int x149 = 0;
+    int x150 = 0;
+    int x151 = 0;
+    int x152 = 0;
+    int x153 = 0;
+    int x154 = 0;
+    int x155 = 0;
+    int x156 = 0;
+    int x157 = 0;
+    int x158 = 0;
+    int x159 = 0;
+    int x160 = 0;
+    int x161 = 0;
+    int x162 = 0;
+    int x163 = 0;
+    int x164 = 0;
+    int x165 = 0;
+    int x166 = 0;
+    int x167 = 0;
+    int x168 = 0;
+    int x169 = 0;
+    int x170 = 0;
+    int x171 = 0;
+    int x172 = 0;
+    int x173 = 0;
+    int x174 = 0;
+    int x175 = 0;
+    int x176 = 0;
+    int x177 = 0;
+    int x178 = 0;
+    int x179 = 0;
+    int x180 = 0;
+    int x181 = 0;
+    int x182 = 0;
+    int x183 = 0;
+    int x184 = 0;
+    int x185 = 0;
+    int x186 = 0;
+    int x187 = 0;
+    int x188 = 0;
+    int x189 = 0;
+    int x190 = 0;
+    int x191 = 0;
+    int x192 = 0;
+    int x193 = 0;
+    int x194 = 0;
+    int x195 = 0;
+    int x196 = 0;
+    int x197 = 0;
+    int x198 = 0;
+    int x199 = 0;
+    int x200 = 0;
+    int & r = c ? x0 : (c ? x1 : (c ? x2 : (c ? x3 : (c ? x4 : (c ? x5 : (c ? x6 : (c ? x7 : (c ? x8 : (c ? x9 : (c ? x10 : (c ? x11 : (c ? x12 : (c ? x13 : (c ? x14 : (c ? x15 : (c ? x16 : (c ? x17 : (c ? x18 : (c ? x19 : (c ? x20 : (c ? x21 : (c ? x22 : (c ? x23 : (c ? x24 : (c ? x25 : (c ? x26 : (c ? x27 : (c ? x28 : (c ? x29 : (c ? x30 : (c ? x31 : (c ? x32 : (c ? x33 : (c ? x34 : (c ? x35 : (c ? x36 : (c ? x37 : (c ? x38 : (c ? x39 : (c ? x40 : (c ? x41 : (c ? x42 : (c ? x43 : (c ? x44 : (c ? x45 : (c ? x46 : (c ? x47 : (c ? x48 : (c ? x49 : (c ? x50 : (c ? x51 : (c ? x52 : (c ? x53 : (c ? x54 : (c ? x55 : (c ? x56 : (c ? x57 : (c ? x58 : (c ? x59 : (c ? x60 : (c ? x61 : (c ? x62 : (c ? x63 : (c ? x64 : (c ? x65 : (c ? x66 : (c ? x67 : (c ? x68 : (c ? x69 : (c ? x70 : (c ? x71 : (c ? x72 : (c ? x73 : (c ? x74 : (c ? x75 : (c ? x76 : (c ? x77 : (c ? x78 : (c ? x79 : (c ? x80 : (c ? x81 : (c ? x82 : (c ? x83 : (c ? x84 : (c ? x85 : (c ? x86 : (c ? x87 : (c ? x88 : (c ? x89 : (c ? x90 : (c ? x91 : (c ? x92 : (c ? x93 : (c ? x94 : (c ? x95 : (c ? x96 : (c ? x97 : (c ? x98 : (c ? x99 : (c ? x100 : (c ? x101 : (c ? x102 : (c ? x103 : (c ? x104 : (c ? x105 : (c ? x106 : (c ? x107 : (c ? x108 : (c ? x109 : (c ? x110 : (c ? x111 : (c ? x112 : (c ? x113 : (c ? x114 : (c ? x115 : (c ? x116 : (c ? x117 : (c ? x118 : (c ? x119 : (c ? x120 : (c ? x121 : (c ? x122 : (c ? x123 : (c ? x124 : (c ? x125 : (c ? x126 : (c ? x127 : (c ? x128 : (c ? x129 : (c ? x130 : (c ? x131 : (c ? x132 : (c ? x133 : (c ? x134 : (c ? x135 : (c ? x136 : (c ? x137 : (c ? x138 : (c ? x139 : (c ? x140 : (c ? x141 : (c ? x142 : (c ? x143 : (c ? x144 : (c ? x145 : (c ? x146 : (c ? x147 : (c ? x148 : (c ? x149 : (c ? x150 : (c ? x151 : (c ? x152 : (c ? x153 : (c ? x154 : (c ? x155 : (c ? x156 : (c ? x157 : (c ? x158 : (c ? x159 : (c ? x160 : (c ? x161 : (c ? x162 : (c ? x163 : (c ? x164 : (c ? x165 : (c ? x166 : (c ? x167 : (c ? x168 : (c ? x169 : (c ? x170 : (c ? x171 : (c ? x172 : (c ? x173 : (c ? x174 : (c ? x175 : (c ? x176 : (c ? x177 : (c ? x178 : (c ? x179 : (c ? x180 : (c ? x181 : (c ? x182 : (c ? x183 : (c ? x184 : (c ? x185 : (c ? x186 : (c ? x187 : (c ? x188 : (c ? x189 : (c ? x190 : (c ? x191 : (c ? x192 : (c ? x193 : (c ? x194 : (c ? x195 : (c ? x196 : (c ? x197 : (c ? x198 : (c ? x199 : x200)))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))));
+    r = 1;
+    return r;
+}
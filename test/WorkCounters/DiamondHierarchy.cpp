@@ -0,0 +1,82 @@
+// RUN: %clang_verify %budget=records-walked:1000 %budget=declarations-inserted:2000 %s
+// expected-no-diagnostics
+
+// Shared bases should be walked only once, the record summary should be
+// computed only once.
+
+struct B0 { };
+struct L1 : virtual B0 { };
+struct R1 : virtual B0 { };
+struct B1 : L1, R1 { };
+struct L2 : virtual B1 { };
+struct R2 : virtual B1 { };
+struct B2 : L2, R2 { };
+struct L3 : virtual B2 { };
+struct R3 : virtual B2 { };
+struct B3 : L3, R3 { };
+struct L4 : virtual B3 { };
+struct R4 : virtual B3 { };
+struct B4 : L4, R4 { };
+struct L5 : virtual B4 { };
+struct R5 : virtual B4 { };
+struct B5 : L5, R5 { };
+struct L6 : virtual B5 { };
+struct R6 : virtual B5 { };
+struct B6 : L6, R6 { };
+struct L7 : virtual B6 { };
+struct R7 : virtual B6 { };
+struct B7 : L7, R7 { };
+struct L8 : virtual B7 { };
+struct R8 : virtual B7 { };
+struct B8 : L8, R8 { };
+struct L9 : virtual B8 { };
+struct R9 : virtual B8 { };
+struct B9 : L9, R9 { };
+struct L10 : virtual B9 { };
+struct R10 : virtual B9 { };
+struct B10 : L10, R10 { };
+struct L11 : virtual B10 { };
+struct R11 : virtual B10 { };
+struct B11 : L11, R11 { };
+struct L12 : virtual B11 { };
+struct R12 : virtual B11 { };
+struct B12 : L12, R12 { };
+struct L13 : virtual B12 { };
+struct R13 : virtual B12 { };
+struct B13 : L13, R13 { };
+struct L14 : virtual B13 { };
+struct R14 : virtual B13 { };
+struct B14 : L14, R14 { };
+struct L15 : virtual B14 { };
+struct R15 : virtual B14 { };
+struct B15 : L15, R15 { };
+struct L16 : virtual B15 { };
+struct R16 : virtual B15 { };
+struct B16 : L16, R16 { };
+struct L17 : virtual B16 { };
+struct R17 : virtual B16 { };
+struct B17 : L17, R17 { };
+struct L18 : virtual B17 { };
+struct R18 : virtual B17 { };
+struct B18 : L18, R18 { };
+struct L19 : virtual B18 { };
+struct R19 : virtual B18 { };
+struct B19 : L19, R19 { };
+struct L20 : virtual B19 { };
+struct R20 : virtual B19 { };
+struct B20 : L20, R20 { };
+
+struct Target : B20 {
+    int t;
+
+    void set0(int const v) { t = v; }
+    void set1(int const v) { t = v; }
+    void set2(int const v) { t = v; }
+    void set3(int const v) { t = v; }
+    void set4(int const v) { t = v; }
+    void set5(int const v) { t = v; }
+    void set6(int const v) { t = v; }
+    void set7(int const v) { t = v; }
+    void set8(int const v) { t = v; }
+    void set9(int const v) { t = v; }
+};
@@ -0,0 +1,29 @@
+// RUN: %clang_verify -Xclang -print-stats %s 2> %t.stats
+// RUN: grep -x '\*\*\* Constantine Memory Footprint:' %t.stats
+// RUN: grep -x '  Usage maps of a function: [0-9]* bytes at peak' %t.stats
+// RUN: grep -x '  Candidate sets: [0-9]* bytes at peak' %t.stats
+// RUN: grep -x '  Record summaries: [0-9]* bytes at peak' %t.stats
+// RUN: grep -x '  Total: [0-9]* bytes at peak' %t.stats
+// RUN: grep -x '  Top functions by usage map footprint:' %t.stats
+// RUN: grep -x ' *[0-9]* bytes  read' %t.stats
+// RUN: grep -x '  Top records by summary footprint:' %t.stats
+// RUN: grep -x ' *[0-9]* bytes  Counter' %t.stats
+// RUN: %clang_verify %s 2> %t.quiet
+// RUN: sed -n '/Constantine Memory Footprint/p' %t.quiet | wc -l | grep '^ *0$'
+
+// The footprint of the analysis is reported with the compiler statistics,
+// and only with those.
+
+struct Counter {
+    int value;
+
+    int get() const {
+        return value;
+    }
+};
+
+int read() {
+    int i[] = { 0, 1, 2 }; // expected-warning {{variable 'i' could be declared as const}}
+    int const k = i[0];
+    return k;
+}
@@ -0,0 +1,211 @@
+// RUN: %clang_verify %budget=declarations-inserted:1000 %budget=candidates-inserted:500 %s
+// RUN: %clang_verify %budget=change-nodes:2000 %budget=register-calls:500 %s
+// expected-no-diagnostics
+
+// The work on a class should not grow with the product of the number of
+// methods and the number of fields.
+
+struct Large {
+    int f0;
+    int f1;
+    int f2;
+    int f3;
+    int f4;
+    int f5;
+    int f6;
+    int f7;
+    int f8;
+    int f9;
+    int f10;
+    int f11;
+    int f12;
+    int f13;
+    int f14;
+    int f15;
+    int f16;
+    int f17;
+    int f18;
+    int f19;
+    int f20;
+    int f21;
+    int f22;
+    int f23;
+    int f24;
+    int f25;
+    int f26;
+    int f27;
+    int f28;
+    int f29;
+    int f30;
+    int f31;
+    int f32;
+    int f33;
+    int f34;
+    int f35;
+    int f36;
+    int f37;
+    int f38;
+    int f39;
+    int f40;
+    int f41;
+    int f42;
+    int f43;
+    int f44;
+    int f45;
+    int f46;
+    int f47;
+    int f48;
+    int f49;
+    int f50;
+    int f51;
+    int f52;
+    int f53;
+    int f54;
+    int f55;
+    int f56;
+    int f57;
+    int f58;
+    int f59;
+    int f60;
+    int f61;
+    int f62;
+    int f63;
+    int f64;
+    int f65;
+    int f66;
+    int f67;
+    int f68;
+    int f69;
+    int f70;
+    int f71;
+    int f72;
+    int f73;
+    int f74;
+    int f75;
+    int f76;
+    int f77;
+    int f78;
+    int f79;
+    int f80;
+    int f81;
+    int f82;
+    int f83;
+    int f84;
+    int f85;
+    int f86;
+    int f87;
+    int f88;
+    int f89;
+    int f90;
+    int f91;
+    int f92;
+    int f93;
+    int f94;
+    int f95;
+    int f96;
+    int f97;
+    int f98;
+    int f99;
+
+    void set0(int const v);
+    void set1(int const v);
+    void set2(int const v);
+    void set3(int const v);
+    void set4(int const v);
+    void set5(int const v);
+    void set6(int const v);
+    void set7(int const v);
+    void set8(int const v);
+    void set9(int const v);
+    void set10(int const v);
+    void set11(int const v);
+    void set12(int const v);
+    void set13(int const v);
+    void set14(int const v);
+    void set15(int const v);
+    void set16(int const v);
+    void set17(int const v);
+    void set18(int const v);
+    void set19(int const v);
+    void set20(int const v);
+    void set21(int const v);
+    void set22(int const v);
+    void set23(int const v);
+    void set24(int const v);
+    void set25(int const v);
+    void set26(int const v);
+    void set27(int const v);
+    void set28(int const v);
+    void set29(int const v);
+    void set30(int const v);
+    void set31(int const v);
+    void set32(int const v);
+    void set33(int const v);
+    void set34(int const v);
+    void set35(int const v);
+    void set36(int const v);
+    void set37(int const v);
+    void set38(int const v);
+    void set39(int const v);
+    void set40(int const v);
+    void set41(int const v);
+    void set42(int const v);
+    void set43(int const v);
+    void set44(int const v);
+    void set45(int const v);
+    void set46(int const v);
+    void set47(int const v);
+    void set48(int const v);
+    void set49(int const v);
+};
+
+void Large::set0(int const v) { f0 = v; f50 = v; }
+void Large::set1(int const v) { f1 = v; f51 = v; }
+void Large::set2(int const v) { f2 = v; f52 = v; }
+void Large::set3(int const v) { f3 = v; f53 = v; }
+void Large::set4(int const v) { f4 = v; f54 = v; }
+void Large::set5(int const v) { f5 = v; f55 = v; }
+void Large::set6(int const v) { f6 = v; f56 = v; }
+void Large::set7(int const v) { f7 = v; f57 = v; }
+void Large::set8(int const v) { f8 = v; f58 = v; }
+void Large::set9(int const v) { f9 = v; f59 = v; }
+void Large::set10(int const v) { f10 = v; f60 = v; }
+void Large::set11(int const v) { f11 = v; f61 = v; }
+void Large::set12(int const v) { f12 = v; f62 = v; }
+void Large::set13(int const v) { f13 = v; f63 = v; }
+void Large::set14(int const v) { f14 = v; f64 = v; }
+void Large::set15(int const v) { f15 = v; f65 = v; }
+void Large::set16(int const v) { f16 = v; f66 = v; }
+void Large::set17(int const v) { f17 = v; f67 = v; }
+void Large::set18(int const v) { f18 = v; f68 = v; }
+void Large::set19(int const v) { f19 = v; f69 = v; }
+void Large::set20(int const v) { f20 = v; f70 = v; }
+void Large::set21(int const v) { f21 = v; f71 = v; }
+void Large::set22(int const v) { f22 = v; f72 = v; }
+void Large::set23(int const v) { f23 = v; f73 = v; }
+void Large::set24(int const v) { f24 = v; f74 = v; }
+void Large::set25(int const v) { f25 = v; f75 = v; }
+void Large::set26(int const v) { f26 = v; f76 = v; }
+void Large::set27(int const v) { f27 = v; f77 = v; }
+void Large::set28(int const v) { f28 = v; f78 = v; }
+void Large::set29(int const v) { f29 = v; f79 = v; }
+void Large::set30(int const v) { f30 = v; f80 = v; }
+void Large::set31(int const v) { f31 = v; f81 = v; }
+void Large::set32(int const v) { f32 = v; f82 = v; }
+void Large::set33(int const v) { f33 = v; f83 = v; }
+void Large::set34(int const v) { f34 = v; f84 = v; }
+void Large::set35(int const v) { f35 = v; f85 = v; }
+void Large::set36(int const v) { f36 = v; f86 = v; }
+void Large::set37(int const v) { f37 = v; f87 = v; }
+void Large::set38(int const v) { f38 = v; f88 = v; }
+void Large::set39(int const v) { f39 = v; f89 = v; }
+void Large::set40(int const v) { f40 = v; f90 = v; }
+void Large::set41(int const v) { f41 = v; f91 = v; }
+void Large::set42(int const v) { f42 = v; f92 = v; }
+void Large::set43(int const v) { f43 = v; f93 = v; }
+void Large::set44(int const v) { f44 = v; f94 = v; }
+void Large::set45(int const v) { f45 = v; f95 = v; }
+void Large::set46(int const v) { f46 = v; f96 = v; }
+void Large::set47(int const v) { f47 = v; f97 = v; }
+void Large::set48(int const v) { f48 = v; f98 = v; }
+void Large::set49(int const v) { f49 = v; f99 = v; }
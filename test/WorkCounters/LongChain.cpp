@@ -0,0 +1,54 @@
+// RUN: %clang_verify %budget=usage-nodes:10000 %budget=this-search-nodes:10000 %s
+// RUN: %clang_verify -DNESTED %budget=usage-nodes:40000 %s
+
+// Long operator chains (and nested conditionals as deep) are walked in
+// linear work.
+
+#define T0 + 1
+#define T1 T0 T0
+#define T2 T1 T1
+#define T3 T2 T2
+#define T4 T3 T3
+#define T5 T4 T4
+#define T6 T5 T5
+#define T7 T6 T6
+#define T8 T7 T7
+#define T9 T8 T8
+#define T10 T9 T9
+#define T11 T10 T10
+#define T12 T11 T11
+
+void consume(int *);
+
+void chain(int * p) {
+    consume(p T12);
+}
+
+struct Holder {
+    int * shift(int * p) const { // expected-warning {{function 'shift' could be declared as static}} expected-warning {{variable 'p' could be declared as const}}
+        return p T12;
+    }
+};
+
+#ifdef NESTED
+#define Q0 c ? x :
+#define Q1 Q0 Q0
+#define Q2 Q1 Q1
+#define Q3 Q2 Q2
+#define Q4 Q3 Q3
+#define Q5 Q4 Q4
+#define Q6 Q5 Q5
+#define Q7 Q6 Q6
+#define Q8 Q7 Q7
+#define Q9 Q8 Q8
+#define Q10 Q9 Q9
+#define Q11 Q10 Q10
+#define Q12 Q11 Q11
+
+int pick(bool const c) {
+    int x = 0;
+    int & r = Q12 x;
+    r = 1;
+    return x;
+}
+#endif
@@ -0,0 +1,178 @@
+#!/usr/bin/env python
+# -*- coding: utf-8 -*-
+
+# Copyright (C) 2012-2014  László Nagy
+# This file is part of Constantine.
+#
+# Constantine implements pseudo const analysis.
+#
+# Constantine is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# Constantine is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+""" Measure the overhead of the plugin on a corpus of preprocessed files.
+
+Every '.ii' file of the corpus directory is compiled (syntax only) without
+and with the plugin. The time and the peak memory of the compiler process
+is measured, the difference is the cost of the plugin. The results are
+written into a JSON file. When a baseline JSON (an earlier output) is
+given, the added costs are compared against it, and the exit code is non
+zero if any file got slower or bigger than the allowed threshold. """
+
+from __future__ import print_function
+
+import argparse
+import json
+import os
+import os.path
+import subprocess
+import sys
+import time
+
+
+FORMAT_VERSION = 1
+
+
+def measure(command):
+    """ Run the command, return the wall time (seconds) and the peak
+    resident set size (kilobytes) of the process. """
+
+    with open(os.devnull, 'w') as null:
+        start = time.time()
+        child = subprocess.Popen(command, stdout=null, stderr=null)
+        _, status, usage = os.wait4(child.pid, 0)
+        elapsed = time.time() - start
+    if not os.WIFEXITED(status) or os.WEXITSTATUS(status) != 0:
+        raise RuntimeError('command failed: {}'.format(' '.join(command)))
+    return elapsed, usage.ru_maxrss
+
+
+def best_of(command, repeat):
+    """ The minimum of the repeated measures is the least noisy one. """
+
+    results = [measure(command) for _ in range(repeat)]
+    return min(r[0] for r in results), min(r[1] for r in results)
+
+
+def measure_file(args, path):
+    compile_command = [args.clang, '-fsyntax-only', '-x', 'c++-cpp-output'] + \
+        args.extra + [path]
+    plugin_command = compile_command[:-1] + \
+        ['-Xclang', '-load', '-Xclang', args.plugin,
+         '-Xclang', '-plugin', '-Xclang', 'constantine', path]
+
+    base_time, base_memory = best_of(compile_command, args.repeat)
+    plugin_time, plugin_memory = best_of(plugin_command, args.repeat)
+    return {
+        'base_seconds': base_time,
+        'plugin_seconds': plugin_time,
+        'added_seconds': max(0.0, plugin_time - base_time),
+        'base_kilobytes': base_memory,
+        'plugin_kilobytes': plugin_memory,
+        'added_kilobytes': max(0, plugin_memory - base_memory)
+    }
+
+
+def run(args):
+    files = sorted(name for name in os.listdir(args.corpus)
+                   if name.endswith('.ii'))
+    if not files:
+        raise RuntimeError('no .ii files in {}'.format(args.corpus))
+
+    results = dict()
+    for name in files:
+        entry = measure_file(args, os.path.join(args.corpus, name))
+        print('{:<40} {:>8.3f}s {:>8}kB'.format(
+            name, entry['added_seconds'], entry['added_kilobytes']))
+        results[name] = entry
+
+    return {
+        'version': FORMAT_VERSION,
+        'clang': args.clang,
+        'files': results,
+        'total': {
+            'added_seconds': sum(e['added_seconds'] for e in results.values()),
+            'added_kilobytes': max(e['added_kilobytes'] for e in results.values())
+        }
+    }
+
+
+def regressed(current, baseline, threshold, slack):
+    """ The current cost is over the baseline more than the threshold
+    (in percent). Small absolute differences are measurement noise. """
+
+    return current > baseline * (1.0 + threshold / 100.0) and \
+        current - baseline > slack
+
+
+def compare(current, baseline, args):
+    if baseline.get('version') != FORMAT_VERSION:
+        raise RuntimeError('baseline format is not supported')
+
+    failures = 0
+    for name, entry in sorted(current['files'].items()):
+        if name not in baseline['files']:
+            continue
+        old = baseline['files'][name]
+        checks = [('time', 'added_seconds', args.min_seconds),
+                  ('memory', 'added_kilobytes', args.min_kilobytes)]
+        for kind, key, slack in checks:
+            if regressed(entry[key], old[key], args.threshold, slack):
+                print('{}: {} regression {} -> {}'.format(
+                    name, kind, old[key], entry[key]))
+                failures += 1
+    return failures
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__)
+    parser.add_argument('corpus', help='directory of preprocessed files')
+    parser.add_argument('--clang', default='clang++',
+                        help='the compiler to run (default: %(default)s)')
+    parser.add_argument('--plugin', required=True,
+                        help='path to the plugin shared library')
+    parser.add_argument('--output', default='throughput.json',
+                        help='result file (default: %(default)s)')
+    parser.add_argument('--baseline',
+                        help='earlier result file to compare against')
+    parser.add_argument('--threshold', type=float, default=10.0,
+                        help='allowed regression in percent '
+                             '(default: %(default)s)')
+    parser.add_argument('--min-seconds', type=float, default=0.05,
+                        help='time differences below are ignored '
+                             '(default: %(default)s)')
+    parser.add_argument('--min-kilobytes', type=int, default=1024,
+                        help='memory differences below are ignored '
+                             '(default: %(default)s)')
+    parser.add_argument('--repeat', type=int, default=3,
+                        help='runs per measure (default: %(default)s)')
+    parser.add_argument('--extra', action='append', default=[],
+                        help='extra compiler argument (repeatable)')
+    args = parser.parse_args()
+
+    try:
+        current = run(args)
+        with open(args.output, 'w') as handle:
+            json.dump(current, handle, indent=2, sort_keys=True)
+
+        if args.baseline:
+            with open(args.baseline, 'r') as handle:
+                baseline = json.load(handle)
+            return 1 if compare(current, baseline, args) else 0
+        return 0
+    except (RuntimeError, IOError, OSError) as error:
+        print('error: {}'.format(error), file=sys.stderr)
+        return 2
+
+
+if __name__ == '__main__':
+    sys.exit(main())